@@ -2,18 +2,30 @@
 #!/bin/bash
 
 # Check if sufficient arguments are provided
-if [ "$#" -ne 2 ]; then
-    echo "Usage: $0 <max_parallel_instances> <execution_runs>"
+if [ "$#" -ne 2 ] && [ "$#" -ne 3 ]; then
+    echo "Usage: $0 <max_parallel_instances> <execution_runs> [<ci_width>]"
     exit 1
 fi
 
 # Read arguments
 max_parallel_instances=$1
 execution_runs=$2
+ci_width=$3
 
 # Build new changes
 ./ns3
 
+# With a target confidence interval width, <execution_runs> is the maximum
+# number of runs per configuration and each configuration stops as soon as
+# its outcome proportions have converged
+if [ -n "$ci_width" ]; then
+    python3 pyscripts/runAdaptive.py -j "$max_parallel_instances" -n "$execution_runs" -w "$ci_width" \
+        -e accuracyMixed10.json \
+        -t type1_noLoss.json,type1_LossBoth1.json,type1_LossBoth3.json,type1_LossBoth6.json,type1_LossUpstream1.json,type1_LossUpstream3.json,type1_LossDownstream6.json,type1_LossDownstream1.json,type1_LossDownstream3.json,type1_LossUpstream6.json \
+        -p drop1_min300pkts.json,drop2_min300pkts.json,drop3_min300pkts.json,drop4_min300pkts.json,drop5_min300pkts.json
+    exit $?
+fi
+
 # Function to check the number of running instances of the process
 check_process_instances() {
     local count=$(pgrep -c "ns3")
@@ -0,0 +1,173 @@
+import os
+import json
+import math
+import time
+import argparse
+import subprocess
+from statistics import NormalDist
+
+CONFIGS_DIR = 'scratch/penny/configs'
+
+# Outcomes of a run, read from the 'finalOutcome' of Penny's results
+OUTCOMES = ['Closed-Loop', 'Not Closed-Loop', 'Duplicates Exceeded', 'Undecided']
+
+def load_config(kind, name):
+    """
+    Load one of the JSON configuration files of the simulator.
+    """
+    with open(os.path.join(CONFIGS_DIR, kind, name), 'r') as f:
+        return json.load(f)
+
+def wilson_interval(successes, runs, z):
+    """
+    Wilson score interval of a binomial proportion.
+    """
+    if runs == 0:
+        return 0.0, 1.0
+    p = successes / runs
+    denominator = 1 + z * z / runs
+    center = (p + z * z / (2 * runs)) / denominator
+    half_width = z * math.sqrt(p * (1 - p) / runs + z * z / (4 * runs * runs)) / denominator
+    return max(0.0, center - half_width), min(1.0, center + half_width)
+
+def read_outcome(results_file):
+    """
+    Read the outcome of the last run written to a results file.
+    """
+    with open(results_file, 'r') as f:
+        lines = [line for line in f if line.strip()]
+    aggregates = json.loads(lines[-1]).get('aggregates', {})
+    outcome = aggregates.get('finalOutcome') or aggregates.get('aggrOutcome') or ''
+    for known in OUTCOMES:
+        # The individual flows report 'Closed-loop'
+        if outcome.lower() == known.lower():
+            return known
+    return 'Undecided'
+
+class Configuration:
+    """
+    One (experiment, topology, penny) combination and the outcomes of its runs.
+    """
+    def __init__(self, experiment, topology, penny):
+        self.experiment = experiment
+        self.topology = topology
+        self.penny = penny
+        self.folder = load_config('experiments', experiment)['experiment']['folder']
+        self.topo_id = load_config('topology', topology)['id']
+        self.drop_rate = load_config('penny', penny)['penny']['dropProbability']
+        self.next_seed = 1
+        self.running = 0
+        self.counts = {outcome: 0 for outcome in OUTCOMES}
+        self.converged = False
+
+    def name(self):
+        return f"{self.experiment}/{self.topology}/{self.penny}"
+
+    def completed(self):
+        return sum(self.counts.values())
+
+    def results_file(self, seed):
+        # Matches the naming of writeResults() in sim.cc (std::to_string of a double)
+        return os.path.join('tempResults', self.folder,
+                            f"{self.topo_id}_{self.drop_rate:f}_{seed}.txt")
+
+    def command(self, seed):
+        return ['./ns3', 'run', '--no-build',
+                f"scratch/penny/sim.cc --argSeed={seed} --argExperimentConf={self.experiment} "
+                f"--argTopologyConf={self.topology} --argPennyConf={self.penny}"]
+
+    def max_width(self, z):
+        """
+        Widest confidence interval among the outcome proportions.
+        """
+        runs = self.completed()
+        return max(hi - lo for lo, hi in
+                   (wilson_interval(self.counts[outcome], runs, z) for outcome in OUTCOMES))
+
+def next_configuration(configs, max_runs):
+    """
+    Pick the unconverged configuration with the fewest issued runs.
+    """
+    candidates = [c for c in configs if not c.converged and c.next_seed <= max_runs]
+    if not candidates:
+        return None
+    return min(candidates, key=lambda c: (c.next_seed - 1, c.running))
+
+def run(configs, parallel, min_runs, max_runs, width, z):
+    """
+    Issue seeds to the configurations until each one either has all its
+    outcome proportions within the target interval width or reaches max_runs.
+    """
+    running = {}
+    while True:
+        while len(running) < parallel:
+            config = next_configuration(configs, max_runs)
+            if config is None:
+                break
+            seed = config.next_seed
+            config.next_seed += 1
+            config.running += 1
+            process = subprocess.Popen(config.command(seed), stdout=subprocess.DEVNULL)
+            running[process] = (config, seed)
+
+        if not running:
+            break
+
+        time.sleep(0.5)
+        for process in [p for p in running if p.poll() is not None]:
+            config, seed = running.pop(process)
+            config.running -= 1
+            try:
+                config.counts[read_outcome(config.results_file(seed))] += 1
+            except (OSError, ValueError, IndexError) as e:
+                print(f"Couldn't read the results of {config.name()} seed {seed}: {e}")
+                continue
+
+            if not config.converged and config.completed() >= min_runs and config.max_width(z) <= width:
+                config.converged = True
+                print(f"{config.name()}: converged after {config.completed()} runs")
+
+def print_summary(configs, max_runs, z):
+    """
+    Print the outcome proportions of every configuration.
+    """
+    total = 0
+    print(f"{'configuration':<70} {'runs':>6} " +
+          " ".join(f"{outcome:>20}" for outcome in OUTCOMES) + f" {'CI width':>9}")
+    for config in configs:
+        runs = config.completed()
+        total += runs
+        proportions = " ".join(f"{config.counts[outcome] / runs if runs else 0:>20.4f}"
+                               for outcome in OUTCOMES)
+        print(f"{config.name():<70} {runs:>6} {proportions} {config.max_width(z):>9.4f}")
+    print(f"Total runs: {total} (fixed-count sweep: {max_runs * len(configs)})")
+
+def main():
+    """
+    Main function to parse arguments and run the experiments adaptively.
+    """
+    parser = argparse.ArgumentParser(description="Run accuracy experiments until the outcome "
+                                                 "proportions of every configuration converge.")
+    parser.add_argument('-e', dest='experiments', help="Comma separated experiment configurations.", type=str, required=True)
+    parser.add_argument('-t', dest='topologies', help="Comma separated topology configurations.", type=str, required=True)
+    parser.add_argument('-p', dest='pennies', help="Comma separated penny configurations.", type=str, required=True)
+    parser.add_argument('-j', dest='parallel', help="Number of parallel runs.", type=int, required=True)
+    parser.add_argument('-n', dest='max_runs', help="Maximum number of runs per configuration.", type=int, required=True)
+    parser.add_argument('-w', dest='width', help="Target width of the confidence intervals.", type=float, default=0.05)
+    parser.add_argument('-c', dest='confidence', help="Confidence level of the intervals.", type=float, default=0.95)
+    parser.add_argument('-m', dest='min_runs', help="Minimum number of runs per configuration.", type=int, default=100)
+    args = parser.parse_args()
+
+    z = NormalDist().inv_cdf(1 - (1 - args.confidence) / 2)
+    configs = [Configuration(experiment, topology, penny)
+               for experiment in args.experiments.split(',')
+               for topology in args.topologies.split(',')
+               for penny in args.pennies.split(',')]
+    for config in configs:
+        os.makedirs(os.path.join('tempResults', config.folder), exist_ok=True)
+
+    run(configs, args.parallel, min(args.min_runs, args.max_runs), args.max_runs, args.width, z)
+    print_summary(configs, args.max_runs, z)
+
+if __name__ == '__main__':
+    main()
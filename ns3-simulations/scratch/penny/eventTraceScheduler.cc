@@ -0,0 +1,33 @@
+#include "eventTraceScheduler.h"
+
+NS_OBJECT_ENSURE_REGISTERED(EventTraceScheduler);
+
+TypeId EventTraceScheduler::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::EventTraceScheduler")
+            .SetParent<MapScheduler>()
+            .AddConstructor<EventTraceScheduler>()
+            .AddAttribute("FileName",
+                          "File the event delays are written to",
+                          StringValue(""),
+                          MakeStringAccessor(&EventTraceScheduler::fileName),
+                          MakeStringChecker());
+    return tid;
+}
+
+void EventTraceScheduler::Insert(const Scheduler::Event& ev)
+{
+    if (!fileName.empty() && !trace.is_open())
+    {
+        trace.open(fileName);
+        trace.precision(9);
+        trace << std::fixed;
+    }
+    if (trace.is_open())
+    {
+        /* Delay of the event from the current time */
+        trace << TimeStep(ev.key.m_ts - Simulator::Now().GetTimeStep()).GetSeconds() << '\n';
+    }
+    MapScheduler::Insert(ev);
+}
@@ -0,0 +1,28 @@
+#ifndef EVENT_TRACE_SCHEDULER_H
+#define EVENT_TRACE_SCHEDULER_H
+
+#include <fstream>
+#include <string>
+
+#include "ns3/core-module.h"
+
+using namespace ns3;
+
+/*
+    Default scheduler which also records the delay of every scheduled
+    event, one per line in seconds, in the format read by the --file
+    option of utils/bench-scheduler.
+*/
+class EventTraceScheduler : public MapScheduler
+{
+  public:
+    static TypeId GetTypeId();
+
+    void Insert(const Scheduler::Event& ev) override;
+
+  private:
+    std::string fileName;
+    std::ofstream trace;
+};
+
+#endif // EVENT_TRACE_SCHEDULER_H
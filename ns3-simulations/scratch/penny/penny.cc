@@ -1,5 +1,7 @@
 #include "penny.h"
 
+#include <chrono>
+
 penny::penny() {}
 
 void penny::Enable()
@@ -41,6 +43,22 @@ void penny::preregisterSpoofedFlow(std::string flowId)
 }
 
 int penny::processPacket(struct simplePacket pkt)
+{
+    auto start = std::chrono::steady_clock::now();
+    int retCode = processPacketUntimed(pkt);
+    perf.processingNs += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - start)
+                             .count();
+    perf.processedPkts++;
+
+    if (finished && perf.decisionTime < 0)
+    {
+        perf.decisionTime = ns3::Simulator::Now().GetSeconds();
+    }
+    return retCode;
+}
+
+int penny::processPacketUntimed(struct simplePacket pkt)
 {
     /* Track the number of packets per type */
     (pkt.isNS3Flow ? totalClosedLoopPackets++ : totalSpoofedPackets++);
@@ -340,6 +358,24 @@ json penny::exportFlowCountersJson(struct pennyCounters counters)
     return exportData;
 }
 
+json penny::exportPerfJson()
+{
+    json exportData;
+
+    exportData["processedPkts"] = perf.processedPkts;
+    exportData["processingSeconds"] = perf.processingNs / 1e9;
+    if (perf.decisionTime >= 0)
+    {
+        exportData["decisionSimSeconds"] = perf.decisionTime;
+    }
+    else
+    {
+        exportData["decisionSimSeconds"] = nullptr;
+    }
+
+    return exportData;
+}
+
 json penny::exportToJson(bool indivFlowsStats)
 {
     json exportData;
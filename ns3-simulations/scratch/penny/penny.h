@@ -27,6 +27,13 @@ struct pennyCounters
     uint64_t pendingDroppedPkts = 0;       // Dropped packets with no decision yet
 };
 
+struct pennyPerfCounters
+{
+    uint64_t processedPkts = 0; // Packets passed to processPacket
+    uint64_t processingNs = 0;  // Wall clock time spent in processPacket
+    double decisionTime = -1;   // Simulation time of the final decision, -1 if none
+};
+
 struct pennyMetaLists
 {
     std::set<std::string> droppedPcksList;
@@ -98,6 +105,9 @@ class penny
 
     json exportToJson(bool);
 
+    /* Export the performance counters. */
+    json exportPerfJson();
+
     json exportFlowCountersJson(struct pennyCounters);
 
     /* Track the number of packets per type */
@@ -108,11 +118,16 @@ class penny
 
     bool indivFlowsEnabled = false;
 
+    struct pennyPerfCounters perf;
+
     std::string aggrOutcome;
     std::string finalOutcome;
 
   private:
     json conf;
+
+    /* Process a single packet, without the performance counters. */
+    int processPacketUntimed(struct simplePacket);
     struct pennyParameters pennyParams;
 
     /* Map flows to pennyFlow instances */
@@ -2,6 +2,7 @@
 
 #include "sim.h"
 #include "penny.h"
+#include "eventTraceScheduler.h"
 
 using namespace ns3;
 
@@ -58,6 +59,20 @@ void writeResults(const std::string& experimentFolder,
     }
 }
 
+json exportRunStatsJson()
+{
+    Simulator::RunStats stats = Simulator::GetRunStats();
+    json exportData;
+
+    exportData["wallClockSeconds"] = stats.wallClock;
+    exportData["peakRssBytes"] = stats.peakMemory;
+    exportData["events"] = stats.events;
+    exportData["eventsPerSecond"] = stats.GetEventRate();
+    exportData["simulatedSeconds"] = stats.simTime.GetSeconds();
+
+    return exportData;
+}
+
 void processPacketNS3(Ptr<const Packet> packet)
 {
     // Transform the NS-3 packet header to the custom SimplePacket format.
@@ -131,13 +146,14 @@ void processPacketNS3(Ptr<const Packet> packet)
 struct simplePacket extractSimplePacket(Ptr<const Packet> packet)
 {
     struct simplePacket pkt = {0};
-    TcpHeader* tcpH = (TcpHeader*)packet->extractTcpHeader();
-    pkt.seq = tcpH->GetSequenceNumber().GetValue();
-    pkt.ack = tcpH->GetAckNumber().GetValue();
+    TcpHeader tcpH;
+    packet->FindHeader(tcpH);
+    pkt.seq = tcpH.GetSequenceNumber().GetValue();
+    pkt.ack = tcpH.GetAckNumber().GetValue();
     pkt.payloadSize = packet->GetPayloadSize();
-    pkt.synFlag = tcpH->IsSYN();
+    pkt.synFlag = tcpH.IsSYN();
     pkt.flowId =
-        std::to_string(tcpH->GetSourcePort()) + "-" + std::to_string(tcpH->GetDestinationPort());
+        std::to_string(tcpH.GetSourcePort()) + "-" + std::to_string(tcpH.GetDestinationPort());
     pkt.packetId = std::to_string(pkt.seq) + "-" + std::to_string(pkt.ack);
     pkt.isNS3Flow = true;
     return pkt;
@@ -290,8 +306,9 @@ void pennyCallback(Ptr<const Packet> packet)
     if (pennyInstance.isEnabled() && pennyInstance.isRunning())
     {
         /* Do not send background traffic to Penny. */
-        TcpHeader* pkt = (TcpHeader*)packet->extractTcpHeader();
-        if (IsPortInRange(pkt->GetSourcePort(), 20000, 21000) || IsPortInRange(pkt->GetDestinationPort(), 20000, 21000))
+        TcpHeader pkt;
+        packet->FindHeader(pkt);
+        if (IsPortInRange(pkt.GetSourcePort(), 20000, 21000) || IsPortInRange(pkt.GetDestinationPort(), 20000, 21000))
         {
             return;
         }
@@ -310,12 +327,16 @@ int main(int argc, char* argv[])
 {
     int argSeed = 0;
     std::string argExperimentConf = "", argTopologyConf = "", argPennyConf = "";
+    std::string argEventTrace = "";
 
     CommandLine cmd;
     cmd.AddValue("argSeed", "Seed for randomness.", argSeed);
     cmd.AddValue("argExperimentConf", "The experiment configuration json file", argExperimentConf);
     cmd.AddValue("argTopologyConf", "The topology configuration json file", argTopologyConf);
     cmd.AddValue("argPennyConf", "The penny configuration json file", argPennyConf);
+    cmd.AddValue("argEventTrace",
+                 "Record the delays of the scheduled events to this file (for bench-scheduler)",
+                 argEventTrace);
     cmd.Parse(argc, argv);
 
     if (argExperimentConf == "" || argTopologyConf == "" || argPennyConf == "")
@@ -324,6 +345,12 @@ int main(int argc, char* argv[])
         exit(-1);
     }
 
+    if (argEventTrace != "")
+    {
+        Config::SetDefault("ns3::EventTraceScheduler::FileName", StringValue(argEventTrace));
+        GlobalValue::Bind("SchedulerType", TypeIdValue(EventTraceScheduler::GetTypeId()));
+    }
+
     /* Set random seed */
     Random::seed((int)argSeed);
 
@@ -532,8 +559,8 @@ int main(int argc, char* argv[])
         std::cout << "No queue type specified in the topology configuration. Supported queue type values are 'PfifoFastQueueDisc' and 'RedQueueDisc'." << std::endl;
     }
 
-    /* To be able to access packet metadata packet printing must be enabled */
-    Packet::EnablePrinting();
+    /* To find the TCP header of the packets, their header index must be enabled */
+    Packet::EnableHeaderIndex();
 
     if (configData["experiment"]["enablePenny"].get<bool>())
     {
@@ -570,7 +597,10 @@ int main(int argc, char* argv[])
     Simulator::Stop(Seconds(configData["simulation"]["stopSimulation"].get<double>()));
     Simulator::Run();
 
-    writeResults(folderName, argSeed, dropRate, topoId, pennyInstance.exportToJson(false));
+    json results = pennyInstance.exportToJson(false);
+    results["perf"]["simulator"] = exportRunStatsJson();
+    results["perf"]["penny"] = pennyInstance.exportPerfJson();
+    writeResults(folderName, argSeed, dropRate, topoId, results);
 
     Simulator::Destroy();
     return 0;
@@ -18,6 +18,7 @@
 
 #include "ns3/application-container.h"
 #include "ns3/boolean.h"
+#include "ns3/buffer.h"
 #include "ns3/bulk-send-application.h"
 #include "ns3/bulk-send-helper.h"
 #include "ns3/inet-socket-address.h"
@@ -261,6 +262,103 @@ BulkSendSeqTsSizeTestCase::DoRun()
     NS_TEST_ASSERT_MSG_EQ(m_received, 300000, "Received the full 300000 bytes");
 }
 
+/**
+ * \ingroup applications-test
+ * \ingroup tests
+ *
+ * This test checks that, once a bulk transfer reached its steady state,
+ * the packets sent and received reuse the buffer storages of the previous
+ * ones instead of allocating new ones.
+ */
+class BulkSendBufferAllocationTestCase : public TestCase
+{
+  public:
+    BulkSendBufferAllocationTestCase();
+
+  private:
+    void DoRun() override;
+    /**
+     * Record a packet successfully received
+     * \param p the packet
+     * \param addr the sender's address
+     */
+    void ReceiveRx(Ptr<const Packet> p, const Address& addr);
+    /// Record the buffer counters at the end of the measurement.
+    void StopMeasurement();
+    uint64_t m_received{0};  //!< number of packets received during the measurement
+    bool m_measuring{false}; //!< whether the measurement is running
+    Buffer::Stats m_stats{}; //!< buffer counters of the measurement
+};
+
+BulkSendBufferAllocationTestCase::BulkSendBufferAllocationTestCase()
+    : TestCase("Check that a steady state transfer does not allocate buffers")
+{
+}
+
+void
+BulkSendBufferAllocationTestCase::ReceiveRx(Ptr<const Packet> p, const Address& addr)
+{
+    if (m_measuring)
+    {
+        m_received++;
+    }
+}
+
+void
+BulkSendBufferAllocationTestCase::StopMeasurement()
+{
+    m_measuring = false;
+    m_stats = Buffer::GetStats();
+}
+
+void
+BulkSendBufferAllocationTestCase::DoRun()
+{
+    Ptr<Node> sender = CreateObject<Node>();
+    Ptr<Node> receiver = CreateObject<Node>();
+    NodeContainer nodes;
+    nodes.Add(sender);
+    nodes.Add(receiver);
+    SimpleNetDeviceHelper simpleHelper;
+    simpleHelper.SetDeviceAttribute("DataRate", StringValue("10Mbps"));
+    simpleHelper.SetChannelAttribute("Delay", StringValue("10ms"));
+    NetDeviceContainer devices;
+    devices = simpleHelper.Install(nodes);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase("10.1.1.0", "255.255.255.0");
+    Ipv4InterfaceContainer i = ipv4.Assign(devices);
+    uint16_t port = 9;
+    BulkSendHelper sourceHelper("ns3::TcpSocketFactory", InetSocketAddress(i.GetAddress(1), port));
+    ApplicationContainer sourceApp = sourceHelper.Install(nodes.Get(0));
+    sourceApp.Start(Seconds(0.0));
+    sourceApp.Stop(Seconds(5.0));
+    PacketSinkHelper sinkHelper("ns3::TcpSocketFactory",
+                                InetSocketAddress(Ipv4Address::GetAny(), port));
+    ApplicationContainer sinkApp = sinkHelper.Install(nodes.Get(1));
+    sinkApp.Start(Seconds(0.0));
+    sinkApp.Stop(Seconds(5.0));
+
+    Ptr<PacketSink> sink = DynamicCast<PacketSink>(sinkApp.Get(0));
+    sink->TraceConnectWithoutContext(
+        "Rx",
+        MakeCallback(&BulkSendBufferAllocationTestCase::ReceiveRx, this));
+
+    Simulator::Schedule(Seconds(2.0), [this]() {
+        Buffer::ResetStats();
+        m_measuring = true;
+    });
+    Simulator::Schedule(Seconds(4.0), &BulkSendBufferAllocationTestCase::StopMeasurement, this);
+
+    Simulator::Run();
+    Simulator::Destroy();
+
+    NS_TEST_ASSERT_MSG_GT(m_received, 1000, "Too few packets received during the measurement");
+    NS_TEST_ASSERT_MSG_EQ(m_stats.allocations, 0, "Buffers allocated in the steady state");
+    NS_TEST_ASSERT_MSG_GT(m_stats.recycled, 0, "Buffers not reused in the steady state");
+}
+
 /**
  * \ingroup applications-test
  * \ingroup tests
@@ -278,6 +376,7 @@ BulkSendTestSuite::BulkSendTestSuite()
 {
     AddTestCase(new BulkSendBasicTestCase, TestCase::QUICK);
     AddTestCase(new BulkSendSeqTsSizeTestCase, TestCase::QUICK);
+    AddTestCase(new BulkSendBufferAllocationTestCase, TestCase::QUICK);
 }
 
 static BulkSendTestSuite g_bulkSendTestSuite; //!< Static variable for test initialization
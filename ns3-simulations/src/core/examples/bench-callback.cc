@@ -0,0 +1,152 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/callback.h"
+#include "ns3/command-line.h"
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/traced-callback.h"
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+/**
+ * \file
+ * \ingroup core-examples
+ * \ingroup callback
+ * Benchmark of the construction and invocation of Callbacks, and of
+ * TracedCallbacks with no, one and two sinks, with the argument types
+ * of a MacTx trace source.
+ *
+ * \code
+ *   ./ns3 run "bench-callback --n=10000000"
+ * \endcode
+ */
+
+using namespace ns3;
+
+namespace
+{
+
+/** Stand-in for a packet, passed by Ptr to the callbacks. */
+class Payload : public SimpleRefCount<Payload>
+{
+  public:
+    uint32_t m_size{1500}; //!< The size.
+};
+
+/** Sink of the callbacks. */
+class Sink
+{
+  public:
+    /**
+     * Count a packet.
+     * \param [in] payload The packet.
+     */
+    void Receive(Ptr<const Payload> payload)
+    {
+        m_bytes += payload->m_size;
+    }
+
+    /**
+     * Count a packet of a bound flow.
+     * \param [in] flow The flow.
+     * \param [in] payload The packet.
+     */
+    void ReceiveFlow(uint32_t flow, Ptr<const Payload> payload)
+    {
+        m_bytes += payload->m_size + flow;
+    }
+
+    /**
+     * Count a packet with a context.
+     * \param [in] context The context.
+     * \param [in] payload The packet.
+     */
+    void ReceiveContext(std::string context, Ptr<const Payload> payload)
+    {
+        m_bytes += payload->m_size + context.size();
+    }
+
+    uint64_t m_bytes{0}; //!< Bytes received.
+};
+
+/**
+ * Time a loop and print its rate.
+ * \tparam F \deduced The type of the loop body.
+ * \param [in] name The name of the loop.
+ * \param [in] n The number of iterations.
+ * \param [in] body The loop body.
+ */
+template <typename F>
+void
+Measure(const std::string& name, uint64_t n, F body)
+{
+    SystemWallClockMs timer;
+    timer.Start();
+    for (uint64_t i = 0; i < n; i++)
+    {
+        body();
+    }
+    int64_t ms = timer.End();
+    std::cout << std::left << std::setw(28) << name << std::right << std::setw(10) << ms
+              << std::setw(14) << (ms > 0 ? n / ms * 1000 : 0) << std::endl;
+}
+
+} // unnamed namespace
+
+int
+main(int argc, char* argv[])
+{
+    uint64_t n = 10000000;
+
+    CommandLine cmd(__FILE__);
+    cmd.Usage("Benchmark of the Callback construction and invocation.");
+    cmd.AddValue("n", "Number of iterations of each loop", n);
+    cmd.Parse(argc, argv);
+
+    Sink sink;
+    Ptr<const Payload> payload = Create<Payload>();
+
+    std::cout << std::left << std::setw(28) << "loop" << std::right << std::setw(10) << "wall(ms)"
+              << std::setw(14) << "ops/s" << std::endl;
+
+    Measure("MakeCallback", n / 10, [&]() {
+        Callback<void, Ptr<const Payload>> cb = MakeCallback(&Sink::Receive, &sink);
+        cb(payload);
+    });
+    Measure("MakeCallback bound", n / 10, [&]() {
+        Callback<void, Ptr<const Payload>> cb = MakeCallback(&Sink::ReceiveFlow, &sink, 1);
+        cb(payload);
+    });
+
+    Callback<void, Ptr<const Payload>> cb = MakeCallback(&Sink::Receive, &sink);
+    Measure("Callback call", n, [&]() { cb(payload); });
+    Callback<void, Ptr<const Payload>> bound = MakeCallback(&Sink::ReceiveFlow, &sink, 1);
+    Measure("Callback call bound", n, [&]() { bound(payload); });
+
+    TracedCallback<Ptr<const Payload>> trace;
+    Measure("TracedCallback 0 sinks", n, [&]() { trace(payload); });
+    trace.ConnectWithoutContext(MakeCallback(&Sink::Receive, &sink));
+    Measure("TracedCallback 1 sink", n, [&]() { trace(payload); });
+    trace.Connect(MakeCallback(&Sink::ReceiveContext, &sink), "/NodeList/0/DeviceList/0/MacTx");
+    Measure("TracedCallback 2 sinks", n, [&]() { trace(payload); });
+
+    // keep the sink alive
+    std::cout << "bytes " << sink.m_bytes << std::endl;
+    return 0;
+}
@@ -0,0 +1,263 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/command-line.h"
+#include "ns3/event-id.h"
+#include "ns3/event-impl.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+#include "ns3/system-wall-clock-ms.h"
+
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-examples
+ * \ingroup events
+ * Benchmark of the event allocation, on the event pattern of a dumbbell.
+ *
+ * Each flow sends a window of packets over its access link to the left
+ * router, which forwards them over the shared bottleneck link; the
+ * receivers acknowledge every packet, and each acknowledgment sends the
+ * next packet and restarts the retransmission timer of the flow. Only
+ * the events are simulated, so that the cost of the event allocation
+ * is not diluted by the packet processing.
+ *
+ * Compare the throughput with and without the event pool:
+ * \code
+ *   ./ns3 run "bench-event-pool --EventPool=false"
+ *   ./ns3 run "bench-event-pool --EventPool=true"
+ * \endcode
+ */
+
+using namespace ns3;
+
+namespace
+{
+
+/** Events of a dumbbell. */
+class Dumbbell
+{
+  public:
+    /**
+     * Constructor.
+     * \param [in] flows Number of flows.
+     * \param [in] window Number of packets in flight per flow.
+     * \param [in] packets Number of packets sent per flow.
+     */
+    Dumbbell(uint32_t flows, uint32_t window, uint32_t packets);
+    /** Start every flow. */
+    void Start();
+
+  private:
+    /**
+     * Send the next packet of a flow, if any.
+     * \param [in] flow The flow.
+     */
+    void Send(uint32_t flow);
+    /**
+     * The access link of a flow is done sending a packet.
+     * \param [in] flow The flow.
+     */
+    void AccessTxDone(uint32_t flow);
+    /**
+     * A packet arrives at the left router.
+     * \param [in] flow The flow of the packet.
+     * \param [in] seq The sequence number of the packet.
+     * \param [in] size The size of the packet.
+     */
+    void Enqueue(uint32_t flow, uint32_t seq, uint32_t size);
+    /** Start sending the packet at the head of the bottleneck queue. */
+    void StartBottleneckTx();
+    /** The bottleneck link is done sending a packet. */
+    void BottleneckTxDone();
+    /**
+     * A packet arrives at its receiver.
+     * \param [in] flow The flow of the packet.
+     * \param [in] seq The sequence number of the packet.
+     */
+    void Receive(uint32_t flow, uint32_t seq);
+    /**
+     * An acknowledgment arrives at its sender.
+     * \param [in] flow The flow of the acknowledgment.
+     * \param [in] seq The acknowledged sequence number.
+     */
+    void Ack(uint32_t flow, uint32_t seq);
+    /**
+     * The retransmission timer of a flow expires.
+     * \param [in] flow The flow.
+     */
+    void Timeout(uint32_t flow);
+
+    uint32_t m_window;                                  //!< Packets in flight per flow.
+    uint32_t m_packets;                                 //!< Packets sent per flow.
+    std::vector<uint32_t> m_sent;                       //!< Packets sent, per flow.
+    std::vector<EventId> m_rto;                         //!< Retransmission timers.
+    std::deque<std::pair<uint32_t, uint32_t>> m_queue;  //!< Bottleneck queue.
+    bool m_busy{false};                                 //!< Bottleneck link busy.
+    Time m_accessTx{NanoSeconds(1200)};                 //!< Access serialization time.
+    Time m_accessDelay{MicroSeconds(10)};               //!< Access propagation delay.
+    Time m_bottleneckTx{NanoSeconds(12000)};            //!< Bottleneck serialization time.
+    Time m_bottleneckDelay{MilliSeconds(10)};           //!< Bottleneck propagation delay.
+    Time m_ackDelay{MilliSeconds(10)};                  //!< Delay of the acknowledgments.
+    Time m_rtoDelay{Seconds(1)};                        //!< Retransmission timeout.
+};
+
+Dumbbell::Dumbbell(uint32_t flows, uint32_t window, uint32_t packets)
+    : m_window(window),
+      m_packets(packets),
+      m_sent(flows, 0),
+      m_rto(flows)
+{
+}
+
+void
+Dumbbell::Start()
+{
+    for (uint32_t flow = 0; flow < m_sent.size(); flow++)
+    {
+        for (uint32_t i = 0; i < m_window; i++)
+        {
+            Send(flow);
+        }
+    }
+}
+
+void
+Dumbbell::Send(uint32_t flow)
+{
+    if (m_sent[flow] == m_packets)
+    {
+        return;
+    }
+    uint32_t seq = m_sent[flow]++;
+    Simulator::Schedule(m_accessTx, &Dumbbell::AccessTxDone, this, flow);
+    Simulator::Schedule(m_accessTx + m_accessDelay, &Dumbbell::Enqueue, this, flow, seq, 1500);
+    if (!m_rto[flow].IsRunning())
+    {
+        m_rto[flow] = Simulator::Schedule(m_rtoDelay, &Dumbbell::Timeout, this, flow);
+    }
+}
+
+void
+Dumbbell::AccessTxDone(uint32_t flow)
+{
+}
+
+void
+Dumbbell::Enqueue(uint32_t flow, uint32_t seq, uint32_t size)
+{
+    m_queue.emplace_back(flow, seq);
+    if (!m_busy)
+    {
+        StartBottleneckTx();
+    }
+}
+
+void
+Dumbbell::StartBottleneckTx()
+{
+    m_busy = true;
+    Simulator::Schedule(m_bottleneckTx, &Dumbbell::BottleneckTxDone, this);
+}
+
+void
+Dumbbell::BottleneckTxDone()
+{
+    auto [flow, seq] = m_queue.front();
+    m_queue.pop_front();
+    Simulator::Schedule(m_bottleneckDelay + m_accessTx + m_accessDelay,
+                        &Dumbbell::Receive,
+                        this,
+                        flow,
+                        seq);
+    m_busy = false;
+    if (!m_queue.empty())
+    {
+        StartBottleneckTx();
+    }
+}
+
+void
+Dumbbell::Receive(uint32_t flow, uint32_t seq)
+{
+    Simulator::Schedule(m_ackDelay, &Dumbbell::Ack, this, flow, seq);
+}
+
+void
+Dumbbell::Ack(uint32_t flow, uint32_t seq)
+{
+    m_rto[flow].Cancel();
+    m_rto[flow] = Simulator::Schedule(m_rtoDelay, &Dumbbell::Timeout, this, flow);
+    Send(flow);
+}
+
+void
+Dumbbell::Timeout(uint32_t flow)
+{
+    if (m_sent[flow] < m_packets)
+    {
+        Send(flow);
+    }
+}
+
+} // unnamed namespace
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t flows = 100;
+    uint32_t window = 10;
+    uint32_t packets = 10000;
+    uint32_t runs = 3;
+
+    CommandLine cmd(__FILE__);
+    cmd.Usage("Benchmark of the event allocation on the events of a dumbbell.\n"
+              "Set --EventPool=false to allocate the events from the heap.");
+    cmd.AddValue("flows", "Number of flows", flows);
+    cmd.AddValue("window", "Number of packets in flight per flow", window);
+    cmd.AddValue("packets", "Number of packets sent per flow", packets);
+    cmd.AddValue("runs", "Number of simulations", runs);
+    cmd.Parse(argc, argv);
+
+    std::cout << std::setw(6) << "run" << std::setw(12) << "events" << std::setw(10) << "wall(ms)"
+              << std::setw(14) << "events/s" << std::setw(8) << "slabs" << std::endl;
+    for (uint32_t run = 0; run < runs; run++)
+    {
+        int64_t ms;
+        {
+            // the timers of the flows must be gone for Destroy() to empty the pool
+            Dumbbell dumbbell(flows, window, packets);
+            Simulator::Schedule(Seconds(0), &Dumbbell::Start, &dumbbell);
+
+            SystemWallClockMs timer;
+            timer.Start();
+            Simulator::Run();
+            ms = timer.End();
+        }
+
+        uint64_t events = Simulator::GetEventCount();
+        uint64_t slabs = EventImpl::GetPoolStats().slabs;
+        Simulator::Destroy();
+
+        std::cout << std::setw(6) << run << std::setw(12) << events << std::setw(10) << ms
+                  << std::setw(14) << (ms > 0 ? events * 1000 / ms : 0) << std::setw(8) << slabs
+                  << std::endl;
+    }
+    return 0;
+}
@@ -27,8 +27,10 @@
 #include "ptr.h"
 #include "simple-ref-count.h"
 
+#include <array>
 #include <functional>
 #include <memory>
+#include <tuple>
 #include <typeinfo>
 #include <utility>
 #include <vector>
@@ -145,17 +147,17 @@ class CallbackComponentBase
     /**
      * Equality test
      *
-     * \param [in] other CallbackComponent Ptr
+     * \param [in] other CallbackComponent
      * \return \c true if we are equal
      */
-    virtual bool IsEqual(std::shared_ptr<const CallbackComponentBase> other) const = 0;
+    virtual bool IsEqual(const CallbackComponentBase& other) const = 0;
 };
 
 /**
  * \ingroup callbackimpl
  * Stores a component of a callback, i.e., the callable object
- * or a bound argument. The purpose of this class is to test
- * the equality of the components of two callbacks.
+ * or a bound argument, and tests the equality of the components
+ * of two callbacks.
  *
  * \tparam T The type of the callback component.
  * \tparam isComparable whether this callback component can be compared to
@@ -175,22 +177,35 @@ class CallbackComponent : public CallbackComponentBase
     {
     }
 
+    /**
+     * Get the value of the component.
+     * \return A reference to the value.
+     */
+    T& Get() const
+    {
+        return m_comp;
+    }
+
     /**
      * Equality test between the values of two components
      *
-     * \param [in] other CallbackComponentBase Ptr
+     * \param [in] other CallbackComponentBase
      * \return \c true if we are equal
      */
-    bool IsEqual(std::shared_ptr<const CallbackComponentBase> other) const override
+    bool IsEqual(const CallbackComponentBase& other) const override
     {
-        auto p = std::dynamic_pointer_cast<const CallbackComponent<T>>(other);
+        auto p = dynamic_cast<const CallbackComponent<T>*>(&other);
 
         // other must have the same type and value as ours
         return !(p == nullptr || p->m_comp != m_comp);
     }
 
   private:
-    T m_comp; //!< the value of the callback component
+    /**
+     * The value of the callback component. Mutable, as the callable
+     * objects and the bound arguments are invoked and passed as lvalues.
+     */
+    mutable T m_comp;
 };
 
 /**
@@ -198,9 +213,7 @@ class CallbackComponent : public CallbackComponentBase
  * Partial specialization of class CallbackComponent with isComparable equal
  * to false. This is required to handle callable objects (such as lambdas and
  * objects returned by std::function and std::bind) that do not provide the
- * equality operator. Given that these objects cannot be compared and the only
- * purpose of the class CallbackComponent is to compare values, no object is
- * stored in this specialized class.
+ * equality operator. Such components are never equal to another one.
  *
  * \tparam T The type of the callback component.
  */
@@ -214,28 +227,63 @@ class CallbackComponent<T, false> : public CallbackComponentBase
      * \param [in] t The value of the callback component
      */
     CallbackComponent(const T& t)
+        : m_comp(t)
+    {
+    }
+
+    /**
+     * Get the value of the component.
+     * \return A reference to the value.
+     */
+    T& Get() const
     {
+        return m_comp;
     }
 
     /**
      * Equality test between functions
      *
-     * \param [in] other CallbackParam Ptr
+     * \param [in] other CallbackComponentBase
      * \return \c true if we are equal
      */
-    bool IsEqual(std::shared_ptr<const CallbackComponentBase> other) const override
+    bool IsEqual(const CallbackComponentBase& other) const override
     {
         return false;
     }
+
+  private:
+    mutable T m_comp; //!< the value of the callback component
 };
 
-/// Vector of callback components
-typedef std::vector<std::shared_ptr<CallbackComponentBase>> CallbackComponentVector;
+/**
+ * \ingroup callbackimpl
+ * Get one of a tuple of callback components.
+ *
+ * \tparam Ts \deduced The types of the components.
+ * \param [in] components The components.
+ * \param [in] i The index of the component.
+ * \return The component.
+ */
+template <typename... Ts>
+const CallbackComponentBase&
+GetCallbackComponent(const std::tuple<CallbackComponent<Ts>...>& components, std::size_t i)
+{
+    return *std::apply(
+        [i](const auto&... component) {
+            std::array<const CallbackComponentBase*, sizeof...(Ts)> array{&component...};
+            return array[i];
+        },
+        components);
+}
 
 /**
  * \ingroup callbackimpl
  * CallbackImpl class with varying numbers of argument types
  *
+ * The callable object and the bound arguments are stored by the
+ * subclasses in the same allocation as the CallbackImpl itself, and
+ * a call goes through a single function pointer, set by the subclass.
+ *
  * \tparam R \explicit The return type of the Callback.
  * \tparam UArgs \explicit The types of any arguments to the Callback.
  */
@@ -244,35 +292,18 @@ class CallbackImpl : public CallbackImplBase
 {
   public:
     /**
-     * Constructor.
-     *
-     * \param func the callable object
-     * \param components the callback components (callable object and bound
-     * arguments)
+     * Get the number of callback components.
+     * \return The number of components, i.e., the callable object and
+     * the bound arguments.
      */
-    CallbackImpl(std::function<R(UArgs...)> func, const CallbackComponentVector& components)
-        : m_func(func),
-          m_components(components)
-    {
-    }
+    virtual std::size_t GetNComponents() const = 0;
 
     /**
-     * Get the stored function.
-     * \return A const reference to the stored function.
+     * Get a callback component.
+     * \param [in] i The index of the component, the callable object first.
+     * \return The component.
      */
-    const std::function<R(UArgs...)>& GetFunction() const
-    {
-        return m_func;
-    }
-
-    /**
-     * Get the vector of callback components.
-     * \return A const reference to the vector of callback components.
-     */
-    const CallbackComponentVector& GetComponents() const
-    {
-        return m_components;
-    }
+    virtual const CallbackComponentBase& GetComponent(std::size_t i) const = 0;
 
     /**
      * Function call operator.
@@ -282,7 +313,7 @@ class CallbackImpl : public CallbackImplBase
      */
     R operator()(UArgs... uargs) const
     {
-        return m_func(uargs...);
+        return m_invoke(this, std::forward<UArgs>(uargs)...);
     }
 
     bool IsEqual(Ptr<const CallbackImplBase> other) const override
@@ -297,23 +328,23 @@ class CallbackImpl : public CallbackImplBase
 
         // if the two callback implementations are made of a distinct number of
         // components, they are different
-        if (m_components.size() != otherDerived->GetComponents().size())
+        if (GetNComponents() != otherDerived->GetNComponents())
         {
             return false;
         }
 
-        // the two functions are equal if they compare equal or the shared pointers
-        // point to the same locations
-        if (!m_components.at(0)->IsEqual(otherDerived->GetComponents().at(0)) &&
-            m_components.at(0) != otherDerived->GetComponents().at(0))
+        // the two functions are equal if they compare equal or they are the
+        // same object, shared by the callbacks bound from the same callback
+        if (!GetComponent(0).IsEqual(otherDerived->GetComponent(0)) &&
+            &GetComponent(0) != &otherDerived->GetComponent(0))
         {
             return false;
         }
 
         // check if the remaining components are equal one by one
-        for (std::size_t i = 1; i < m_components.size(); i++)
+        for (std::size_t i = 1; i < GetNComponents(); i++)
         {
-            if (!m_components.at(i)->IsEqual(otherDerived->GetComponents().at(i)))
+            if (!GetComponent(i).IsEqual(otherDerived->GetComponent(i)))
             {
                 return false;
             }
@@ -346,12 +377,188 @@ class CallbackImpl : public CallbackImplBase
         return id;
     }
 
+  protected:
+    /** Type of the function invoking the callable object of a subclass. */
+    typedef R (*Invoker)(const CallbackImpl*, UArgs...);
+
+    /**
+     * Constructor.
+     *
+     * \param [in] invoke The function invoking the callable object.
+     */
+    CallbackImpl(Invoker invoke)
+        : m_invoke(invoke)
+    {
+    }
+
   private:
-    /// Stores the callable object associated with this callback (as a lambda)
-    std::function<R(UArgs...)> m_func;
+    /// Invokes the callable object of the subclass
+    Invoker m_invoke;
+};
+
+/**
+ * \ingroup callbackimpl
+ * CallbackImpl of a callable object, with the arguments bound when the
+ * Callback is built from the callable object.
+ *
+ * \tparam T \explicit The type of the callable object.
+ * \tparam isComparable \explicit Whether the callable object can be compared.
+ * \tparam BArgs \explicit The std::tuple of the types of the bound arguments.
+ * \tparam R \explicit The return type of the Callback.
+ * \tparam UArgs \explicit The types of any arguments to the Callback.
+ */
+template <typename T, bool isComparable, typename BArgs, typename R, typename... UArgs>
+class CallbackFunctorImpl;
+
+/**
+ * \ingroup callbackimpl
+ * \copydoc CallbackFunctorImpl
+ */
+template <typename T, bool isComparable, typename... BArgs, typename R, typename... UArgs>
+class CallbackFunctorImpl<T, isComparable, std::tuple<BArgs...>, R, UArgs...>
+    : public CallbackImpl<R, UArgs...>
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * \param [in] func The callable object.
+     * \param [in] bargs The values of the bound arguments.
+     */
+    CallbackFunctorImpl(const T& func, const BArgs&... bargs)
+        : CallbackImpl<R, UArgs...>(&Invoke),
+          m_func(func),
+          m_bargs(bargs...)
+    {
+    }
+
+    std::size_t GetNComponents() const override
+    {
+        return 1 + sizeof...(BArgs);
+    }
+
+    const CallbackComponentBase& GetComponent(std::size_t i) const override
+    {
+        if (i == 0)
+        {
+            return m_func;
+        }
+        return GetCallbackComponent(m_bargs, i - 1);
+    }
 
-    /// Stores the original callable object and the bound arguments, if any
-    std::vector<std::shared_ptr<CallbackComponentBase>> m_components;
+  private:
+    /**
+     * Invoke the callable object.
+     *
+     * \param [in] impl This CallbackImpl.
+     * \param uargs The arguments to the Callback.
+     * \return Callback value
+     */
+    static R Invoke(const CallbackImpl<R, UArgs...>* impl, UArgs... uargs)
+    {
+        auto self = static_cast<const CallbackFunctorImpl*>(impl);
+        if constexpr (std::is_member_pointer_v<T> && sizeof...(BArgs) > 0)
+        {
+            // the object is passed by value, as the called method may release
+            // this CallbackImpl, and the object bound to it, e.g., a socket
+            // which closes itself from its receive callback
+            return std::apply(
+                [&](auto& obj, auto&... bargs) -> R {
+                    auto object = obj.Get();
+                    return static_cast<R>(std::invoke(self->m_func.Get(),
+                                                      object,
+                                                      bargs.Get()...,
+                                                      std::forward<UArgs>(uargs)...));
+                },
+                self->m_bargs);
+        }
+        else
+        {
+            return std::apply(
+                [&](auto&... bargs) -> R {
+                    return static_cast<R>(std::invoke(self->m_func.Get(),
+                                                      bargs.Get()...,
+                                                      std::forward<UArgs>(uargs)...));
+                },
+                self->m_bargs);
+        }
+    }
+
+    CallbackComponent<T, isComparable> m_func;           //!< the callable object
+    std::tuple<CallbackComponent<BArgs>...> m_bargs;     //!< the bound arguments
+};
+
+/**
+ * \ingroup callbackimpl
+ * CallbackImpl binding the first arguments of another CallbackImpl.
+ *
+ * \tparam Prev \explicit The type of the CallbackImpl whose arguments are bound.
+ * \tparam BArgs \explicit The std::tuple of the types of the bound arguments.
+ * \tparam R \explicit The return type of the Callback.
+ * \tparam UArgs \explicit The types of any arguments to the Callback.
+ */
+template <typename Prev, typename BArgs, typename R, typename... UArgs>
+class CallbackBoundImpl;
+
+/**
+ * \ingroup callbackimpl
+ * \copydoc CallbackBoundImpl
+ */
+template <typename Prev, typename... BArgs, typename R, typename... UArgs>
+class CallbackBoundImpl<Prev, std::tuple<BArgs...>, R, UArgs...> : public CallbackImpl<R, UArgs...>
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * \param [in] prev The CallbackImpl whose arguments are bound.
+     * \param [in] bargs The values of the bound arguments.
+     */
+    CallbackBoundImpl(Ptr<Prev> prev, const BArgs&... bargs)
+        : CallbackImpl<R, UArgs...>(&Invoke),
+          m_prev(prev),
+          m_bargs(bargs...)
+    {
+    }
+
+    std::size_t GetNComponents() const override
+    {
+        return m_prev->GetNComponents() + sizeof...(BArgs);
+    }
+
+    const CallbackComponentBase& GetComponent(std::size_t i) const override
+    {
+        std::size_t n = m_prev->GetNComponents();
+        if (i < n)
+        {
+            return m_prev->GetComponent(i);
+        }
+        return GetCallbackComponent(m_bargs, i - n);
+    }
+
+  private:
+    /**
+     * Invoke the previous CallbackImpl with the bound arguments.
+     *
+     * \param [in] impl This CallbackImpl.
+     * \param uargs The arguments to the Callback.
+     * \return Callback value
+     */
+    static R Invoke(const CallbackImpl<R, UArgs...>* impl, UArgs... uargs)
+    {
+        auto self = static_cast<const CallbackBoundImpl*>(impl);
+        // keep the previous CallbackImpl alive for the duration of the call,
+        // see CallbackFunctorImpl::Invoke
+        Ptr<Prev> prev = self->m_prev;
+        return std::apply(
+            [&](auto&... bargs) -> R {
+                return (*prev)(bargs.Get()..., std::forward<UArgs>(uargs)...);
+            },
+            self->m_bargs);
+    }
+
+    Ptr<Prev> m_prev;                                //!< the CallbackImpl whose arguments are bound
+    std::tuple<CallbackComponent<BArgs>...> m_bargs; //!< the bound arguments
 };
 
 /**
@@ -467,17 +674,10 @@ class Callback : public CallbackBase
     template <typename... BArgs>
     Callback(const Callback<R, BArgs..., UArgs...>& cb, BArgs... bargs)
     {
-        auto f = cb.DoPeekImpl()->GetFunction();
-
-        CallbackComponentVector components(cb.DoPeekImpl()->GetComponents());
-        components.insert(components.end(),
-                          {std::make_shared<CallbackComponent<std::decay_t<BArgs>>>(bargs)...});
-
-        m_impl = Create<CallbackImpl<R, UArgs...>>(
-            [f, bargs...](auto&&... uargs) -> R {
-                return f(bargs..., std::forward<decltype(uargs)>(uargs)...);
-            },
-            components);
+        m_impl = Create<CallbackBoundImpl<CallbackImpl<R, BArgs..., UArgs...>,
+                                          std::tuple<std::decay_t<BArgs>...>,
+                                          R,
+                                          UArgs...>>(cb.DoPeekImpl(), bargs...);
     }
 
     /**
@@ -498,23 +698,16 @@ class Callback : public CallbackBase
               typename... BArgs>
     Callback(T func, BArgs... bargs)
     {
-        // store the function in a std::function object
-        std::function<R(BArgs..., UArgs...)> f(func);
-
         // The original function is comparable if it is a function pointer or
         // a pointer to a member function or a pointer to a member data.
         constexpr bool isComp =
             std::is_function_v<std::remove_pointer_t<T>> || std::is_member_pointer_v<T>;
 
-        CallbackComponentVector components(
-            {std::make_shared<CallbackComponent<T, isComp>>(func),
-             std::make_shared<CallbackComponent<std::decay_t<BArgs>>>(bargs)...});
-
-        m_impl = Create<CallbackImpl<R, UArgs...>>(
-            [f, bargs...](auto&&... uargs) -> R {
-                return f(bargs..., std::forward<decltype(uargs)>(uargs)...);
-            },
-            components);
+        // the function and the bound arguments are stored in the implementation
+        m_impl = Create<
+            CallbackFunctorImpl<T, isComp, std::tuple<std::decay_t<BArgs>...>, R, UArgs...>>(
+            func,
+            bargs...);
     }
 
   private:
@@ -535,17 +728,13 @@ class Callback : public CallbackBase
     {
         Callback<R, std::tuple_element_t<sizeof...(bargs) + INDEX, std::tuple<UArgs...>>...> cb;
 
-        const auto f = DoPeekImpl()->GetFunction();
-
-        CallbackComponentVector components(DoPeekImpl()->GetComponents());
-        components.insert(components.end(),
-                          {std::make_shared<CallbackComponent<std::decay_t<BoundArgs>>>(bargs)...});
-
-        cb.m_impl = Create<std::remove_pointer_t<decltype(cb.DoPeekImpl())>>(
-            [f, bargs...](auto&&... uargs) mutable {
-                return f(bargs..., std::forward<decltype(uargs)>(uargs)...);
-            },
-            components);
+        cb.m_impl = Create<
+            CallbackBoundImpl<CallbackImpl<R, UArgs...>,
+                              std::tuple<std::decay_t<BoundArgs>...>,
+                              R,
+                              std::tuple_element_t<sizeof...(bargs) + INDEX, std::tuple<UArgs...>>...>>(
+            DoPeekImpl(),
+            bargs...);
 
         return cb;
     }
@@ -590,7 +779,7 @@ class Callback : public CallbackBase
      */
     R operator()(UArgs... uargs) const
     {
-        return (*(DoPeekImpl()))(uargs...);
+        return (*(DoPeekImpl()))(std::forward<UArgs>(uargs)...);
     }
 
     /**
@@ -754,6 +943,37 @@ MakeNullCallback()
     return Callback<R, Args...>();
 }
 
+/**
+ * \ingroup makeboundcallback
+ * Build a Callback binding its first arguments, with the function and
+ * all the bound arguments in a single CallbackImpl, rather than in a
+ * CallbackImpl bound by Callback::Bind() to the CallbackImpl of the function.
+ *
+ * \tparam R \explicit Return type of the callback.
+ * \tparam Args \explicit std::tuple of the argument types of the function,
+ * without the class instance.
+ * \tparam NBOUND \explicit Number of bound arguments, without the class instance.
+ * \tparam T \deduced Type of the function.
+ * \tparam INDEX \deduced Indexes of the arguments left unbound.
+ * \tparam BArgs \deduced Type list of bound arguments, with the class instance.
+ * \param [in] seq A compile-time integer sequence 0..N-1, where N is the
+ * number of arguments left unbound.
+ * \param [in] func The function.
+ * \param [in] bargs The bound arguments.
+ * \return The bound Callback
+ */
+template <typename R,
+          typename Args,
+          std::size_t NBOUND,
+          typename T,
+          std::size_t... INDEX,
+          typename... BArgs>
+Callback<R, std::tuple_element_t<NBOUND + INDEX, Args>...>
+DoMakeBoundCallback(std::index_sequence<INDEX...> seq, T func, BArgs... bargs)
+{
+    return Callback<R, std::tuple_element_t<NBOUND + INDEX, Args>...>(func, bargs...);
+}
+
 /**
  * \ingroup makeboundcallback
  * @{
@@ -769,7 +989,10 @@ template <typename R, typename... Args, typename... BArgs>
 auto
 MakeBoundCallback(R (*fnPtr)(Args...), BArgs&&... bargs)
 {
-    return Callback<R, Args...>(fnPtr).Bind(std::forward<BArgs>(bargs)...);
+    return DoMakeBoundCallback<R, std::tuple<Args...>, sizeof...(BArgs)>(
+        std::make_index_sequence<sizeof...(Args) - sizeof...(BArgs)>{},
+        fnPtr,
+        std::forward<BArgs>(bargs)...);
 }
 
 /**
@@ -790,14 +1013,22 @@ template <typename T, typename OBJ, typename R, typename... Args, typename... BA
 auto
 MakeCallback(R (T::*memPtr)(Args...), OBJ objPtr, BArgs... bargs)
 {
-    return Callback<R, Args...>(memPtr, objPtr).Bind(bargs...);
+    return DoMakeBoundCallback<R, std::tuple<Args...>, sizeof...(BArgs)>(
+        std::make_index_sequence<sizeof...(Args) - sizeof...(BArgs)>{},
+        memPtr,
+        objPtr,
+        bargs...);
 }
 
 template <typename T, typename OBJ, typename R, typename... Args, typename... BArgs>
 auto
 MakeCallback(R (T::*memPtr)(Args...) const, OBJ objPtr, BArgs... bargs)
 {
-    return Callback<R, Args...>(memPtr, objPtr).Bind(bargs...);
+    return DoMakeBoundCallback<R, std::tuple<Args...>, sizeof...(BArgs)>(
+        std::make_index_sequence<sizeof...(Args) - sizeof...(BArgs)>{},
+        memPtr,
+        objPtr,
+        bargs...);
 }
 
 /**@}*/
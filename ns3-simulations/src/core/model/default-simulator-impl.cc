@@ -23,7 +23,9 @@
 #include "log.h"
 #include "scheduler.h"
 #include "simulator.h"
+#include "string.h"
 
+#include <chrono>
 #include <cmath>
 
 /**
@@ -48,7 +50,14 @@ DefaultSimulatorImpl::GetTypeId()
     static TypeId tid = TypeId("ns3::DefaultSimulatorImpl")
                             .SetParent<SimulatorImpl>()
                             .SetGroupName("Core")
-                            .AddConstructor<DefaultSimulatorImpl>();
+                            .AddConstructor<DefaultSimulatorImpl>()
+                            .AddAttribute("EventProfile",
+                                          "If not empty, time each event and write the profile "
+                                          "of the events to the files with this name prefix, "
+                                          "with the .txt and .folded extensions, at Destroy",
+                                          StringValue(""),
+                                          MakeStringAccessor(&DefaultSimulatorImpl::m_eventProfile),
+                                          MakeStringChecker());
     return tid;
 }
 
@@ -90,6 +99,11 @@ void
 DefaultSimulatorImpl::Destroy()
 {
     NS_LOG_FUNCTION(this);
+    if (m_profiler)
+    {
+        m_profiler->Write(m_eventProfile);
+        m_profiler.reset();
+    }
     while (!m_destroyEvents.empty())
     {
         Ptr<EventImpl> ev = m_destroyEvents.front().PeekEventImpl();
@@ -141,7 +155,19 @@ DefaultSimulatorImpl::ProcessOneEvent()
     m_currentTs = next.key.m_ts;
     m_currentContext = next.key.m_context;
     m_currentUid = next.key.m_uid;
-    next.impl->Invoke();
+    if (m_profiler)
+    {
+        auto start = std::chrono::steady_clock::now();
+        next.impl->Invoke();
+        auto end = std::chrono::steady_clock::now();
+        m_profiler->Record(
+            next.impl,
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+    else
+    {
+        next.impl->Invoke();
+    }
     next.impl->Unref();
 
     ProcessEventsWithContext();
@@ -191,6 +217,10 @@ DefaultSimulatorImpl::Run()
     m_mainThreadId = std::this_thread::get_id();
     ProcessEventsWithContext();
     m_stop = false;
+    if (!m_eventProfile.empty() && !m_profiler)
+    {
+        m_profiler = std::make_unique<EventProfiler>();
+    }
 
     while (!m_events->IsEmpty() && !m_stop)
     {
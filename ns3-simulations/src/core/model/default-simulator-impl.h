@@ -20,9 +20,11 @@
 #ifndef DEFAULT_SIMULATOR_IMPL_H
 #define DEFAULT_SIMULATOR_IMPL_H
 
+#include "event-profiler.h"
 #include "simulator-impl.h"
 
 #include <list>
+#include <memory>
 #include <mutex>
 #include <thread>
 
@@ -136,6 +138,11 @@ class DefaultSimulatorImpl : public SimulatorImpl
 
     /** Main execution thread. */
     std::thread::id m_mainThreadId;
+
+    /** File name prefix of the event profile, empty if not profiled. */
+    std::string m_eventProfile;
+    /** The event profiler, if the events are profiled. */
+    std::unique_ptr<EventProfiler> m_profiler;
 };
 
 } // namespace ns3
@@ -19,8 +19,15 @@
 
 #include "event-impl.h"
 
+#include "assert.h"
+#include "boolean.h"
+#include "global-value.h"
 #include "log.h"
 
+#include <atomic>
+#include <new>
+#include <vector>
+
 /**
  * \file
  * \ingroup events
@@ -32,6 +39,261 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("EventImpl");
 
+/**
+ * \ingroup events
+ * \anchor GlobalValueEventPool
+ * Whether events are allocated from the per-thread event pools.
+ *
+ * Read once, when the first event is allocated.
+ */
+static GlobalValue g_eventPool =
+    GlobalValue("EventPool",
+                "Allocate the events from per-thread pools instead of the heap",
+                BooleanValue(true),
+                MakeBooleanChecker());
+
+namespace
+{
+
+/** Granularity of the size classes, in bytes. */
+constexpr std::size_t POOL_GRANULARITY = 16;
+/** Largest event allocated from the pools, in bytes. */
+constexpr std::size_t POOL_MAX_SIZE = 256;
+/** Number of size classes. */
+constexpr std::size_t POOL_CLASSES = POOL_MAX_SIZE / POOL_GRANULARITY;
+/** Size and alignment of the slabs, in bytes. */
+constexpr std::size_t POOL_SLAB_SIZE = 64 * 1024;
+
+/** A released block, linked in the free list of its size class. */
+struct FreeBlock
+{
+    FreeBlock* next; //!< Next free block.
+};
+
+class EventPool;
+
+/**
+ * Header at the start of every slab. As the slabs are aligned to their
+ * size, the slab of a block, and hence the pool which owns it, is found
+ * by masking its address.
+ */
+struct alignas(POOL_GRANULARITY) SlabHeader
+{
+    EventPool* owner; //!< The pool the slab belongs to.
+};
+
+/**
+ * The event pool of a thread.
+ *
+ * Each size class has a free list and a bump pointer into its current
+ * slab. Blocks released by other threads are pushed on a lock-free
+ * list, which the owner takes over when its own free list is empty.
+ */
+class EventPool
+{
+  public:
+    /**
+     * \returns The pool of the calling thread, created if needed.
+     */
+    static EventPool* Current();
+
+    /**
+     * Allocate a block.
+     * \param [in] cls The size class of the block.
+     * \returns The block.
+     */
+    void* Allocate(std::size_t cls);
+    /**
+     * Release a block, from any thread.
+     * \param [in] ptr The block.
+     * \param [in] cls The size class of the block.
+     */
+    void Free(void* ptr, std::size_t cls);
+    /**
+     * Free the slabs if no block is in use.
+     * \returns true if the slabs have been freed.
+     */
+    bool Release();
+    /**
+     * \returns The statistics of the pool.
+     */
+    EventImpl::PoolStats GetStats() const;
+    /**
+     * Called when the owner thread exits: the pool is deleted, unless
+     * some of its blocks are still in use, in which case it is kept
+     * alive (and leaked) so that they can still be released.
+     */
+    void Abandon();
+
+  private:
+    /** \returns The number of blocks in use. */
+    uint64_t Live() const;
+
+    FreeBlock* m_free[POOL_CLASSES]{};              //!< Free lists.
+    std::atomic<FreeBlock*> m_remote[POOL_CLASSES]{}; //!< Blocks released by other threads.
+    char* m_bump[POOL_CLASSES]{};                   //!< Next never used block.
+    char* m_end[POOL_CLASSES]{};                    //!< End of the current slab.
+    std::vector<void*> m_slabs;                     //!< Slabs held by the pool.
+    uint64_t m_allocations{0};                      //!< Blocks allocated.
+    uint64_t m_freed{0};                            //!< Blocks released by the owner.
+    std::atomic<uint64_t> m_remoteFreed{0};         //!< Blocks released by other threads.
+};
+
+/** The pool of the calling thread. */
+thread_local EventPool* t_pool = nullptr;
+
+/** Abandons the pool of a thread when it exits. */
+struct EventPoolGuard
+{
+    ~EventPoolGuard()
+    {
+        if (t_pool != nullptr)
+        {
+            EventPool* pool = t_pool;
+            t_pool = nullptr;
+            pool->Abandon();
+        }
+    }
+};
+
+/** Registers the pool of the calling thread for EventPoolGuard. */
+thread_local EventPoolGuard t_poolGuard;
+
+EventPool*
+EventPool::Current()
+{
+    if (t_pool == nullptr)
+    {
+        t_pool = new EventPool();
+        // odr-use the guard so that it is constructed, and hence destroyed
+        (void)&t_poolGuard;
+    }
+    return t_pool;
+}
+
+void*
+EventPool::Allocate(std::size_t cls)
+{
+    m_allocations++;
+    FreeBlock* block = m_free[cls];
+    if (block == nullptr)
+    {
+        block = m_remote[cls].exchange(nullptr, std::memory_order_acquire);
+    }
+    if (block != nullptr)
+    {
+        m_free[cls] = block->next;
+        return block;
+    }
+
+    std::size_t size = (cls + 1) * POOL_GRANULARITY;
+    if (m_bump[cls] + size > m_end[cls])
+    {
+        void* slab = ::operator new(POOL_SLAB_SIZE, std::align_val_t(POOL_SLAB_SIZE));
+        static_cast<SlabHeader*>(slab)->owner = this;
+        m_slabs.push_back(slab);
+        m_bump[cls] = static_cast<char*>(slab) + sizeof(SlabHeader);
+        m_end[cls] = static_cast<char*>(slab) + POOL_SLAB_SIZE;
+    }
+    void* ptr = m_bump[cls];
+    m_bump[cls] += size;
+    return ptr;
+}
+
+void
+EventPool::Free(void* ptr, std::size_t cls)
+{
+    auto block = static_cast<FreeBlock*>(ptr);
+    if (this == t_pool)
+    {
+        block->next = m_free[cls];
+        m_free[cls] = block;
+        m_freed++;
+        return;
+    }
+    // the owner only ever takes the whole list, so there is no ABA issue
+    block->next = m_remote[cls].load(std::memory_order_relaxed);
+    while (!m_remote[cls].compare_exchange_weak(block->next,
+                                                block,
+                                                std::memory_order_release,
+                                                std::memory_order_relaxed))
+    {
+    }
+    m_remoteFreed.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t
+EventPool::Live() const
+{
+    return m_allocations - m_freed - m_remoteFreed.load(std::memory_order_acquire);
+}
+
+bool
+EventPool::Release()
+{
+    if (Live() != 0)
+    {
+        return false;
+    }
+    for (void* slab : m_slabs)
+    {
+        ::operator delete(slab, std::align_val_t(POOL_SLAB_SIZE));
+    }
+    m_slabs.clear();
+    for (std::size_t cls = 0; cls < POOL_CLASSES; cls++)
+    {
+        m_free[cls] = nullptr;
+        m_remote[cls].store(nullptr, std::memory_order_relaxed);
+        m_bump[cls] = nullptr;
+        m_end[cls] = nullptr;
+    }
+    return true;
+}
+
+EventImpl::PoolStats
+EventPool::GetStats() const
+{
+    return {m_allocations, m_slabs.size(), Live()};
+}
+
+void
+EventPool::Abandon()
+{
+    if (Release())
+    {
+        delete this;
+    }
+}
+
+/**
+ * \returns true if the events are allocated from the pools.
+ *
+ * The value is frozen on first use, so that every event is released
+ * the way it has been allocated.
+ */
+bool
+PoolEnabled()
+{
+    static const bool enabled = []() {
+        BooleanValue value;
+        g_eventPool.GetValue(value);
+        return value.Get();
+    }();
+    return enabled;
+}
+
+/**
+ * \param [in] size The size of an event, in bytes.
+ * \returns The size class of the event.
+ */
+inline std::size_t
+SizeClass(std::size_t size)
+{
+    return (size - 1) / POOL_GRANULARITY;
+}
+
+} // unnamed namespace
+
 EventImpl::~EventImpl()
 {
     NS_LOG_FUNCTION(this);
@@ -67,4 +329,48 @@ EventImpl::IsCancelled()
     return m_cancel;
 }
 
+void*
+EventImpl::operator new(std::size_t size)
+{
+    if (size > POOL_MAX_SIZE || !PoolEnabled())
+    {
+        return ::operator new(size);
+    }
+    return EventPool::Current()->Allocate(SizeClass(size));
+}
+
+void
+EventImpl::operator delete(void* ptr, std::size_t size)
+{
+    if (size > POOL_MAX_SIZE || !PoolEnabled())
+    {
+        ::operator delete(ptr);
+        return;
+    }
+    auto slab = reinterpret_cast<SlabHeader*>(reinterpret_cast<uintptr_t>(ptr) &
+                                              ~(uintptr_t)(POOL_SLAB_SIZE - 1));
+    NS_ASSERT(slab->owner != nullptr);
+    slab->owner->Free(ptr, SizeClass(size));
+}
+
+EventImpl::PoolStats
+EventImpl::GetPoolStats()
+{
+    if (t_pool == nullptr)
+    {
+        return {0, 0, 0};
+    }
+    return t_pool->GetStats();
+}
+
+void
+EventImpl::ReleasePool()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    if (t_pool != nullptr && !t_pool->Release())
+    {
+        NS_LOG_LOGIC("Events still alive, keeping the pool");
+    }
+}
+
 } // namespace ns3
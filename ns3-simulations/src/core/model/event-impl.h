@@ -21,6 +21,7 @@
 
 #include "simple-ref-count.h"
 
+#include <cstddef>
 #include <stdint.h>
 
 /**
@@ -41,6 +42,13 @@ namespace ns3
  * when it reaches the time associated to this event. Most subclasses
  * are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * Events are allocated and released at a very high rate, so, unless
+ * the \ref GlobalValueEventPool "EventPool" global value is false,
+ * their memory is taken from a per-thread pool of fixed size classes
+ * carved out of larger slabs, rather than from the general purpose
+ * heap. An event can be released from any thread: the memory is given
+ * back to the pool of the thread which allocated it.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
@@ -67,6 +75,44 @@ class EventImpl : public SimpleRefCount<EventImpl>
      */
     bool IsCancelled();
 
+    /**
+     * Allocate the memory of an event.
+     *
+     * \param [in] size The size of the event, in bytes.
+     * \returns The memory of the event.
+     */
+    static void* operator new(std::size_t size);
+    /**
+     * Release the memory of an event.
+     *
+     * \param [in] ptr The memory of the event.
+     * \param [in] size The size of the event, in bytes.
+     */
+    static void operator delete(void* ptr, std::size_t size);
+
+    /** Statistics of the event pool of a thread. */
+    struct PoolStats
+    {
+        uint64_t allocations; //!< Events allocated since the pool was created.
+        uint64_t slabs;       //!< Slabs currently held by the pool.
+        uint64_t live;        //!< Events allocated and not yet released.
+    };
+
+    /**
+     * Get the statistics of the event pool of the calling thread.
+     *
+     * \returns The statistics of the pool.
+     */
+    static PoolStats GetPoolStats();
+    /**
+     * Give the memory of the event pool of the calling thread back to
+     * the heap, if none of its events is still alive.
+     *
+     * Called by Simulator::Destroy(), so that every simulation
+     * starts with an empty pool.
+     */
+    static void ReleasePool();
+
   protected:
     /**
      * Implementation for Invoke().
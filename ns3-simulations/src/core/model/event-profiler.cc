@@ -0,0 +1,272 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "event-profiler.h"
+
+#include "event-impl.h"
+#include "fatal-error.h"
+#include "log.h"
+#include "type-id.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <regex>
+#include <vector>
+
+#if (__GNUC__ >= 3)
+#include <cstdlib>
+#include <cxxabi.h>
+#endif
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("EventProfiler");
+
+namespace
+{
+
+/**
+ * \ingroup simulator
+ * \brief Demangle a C++ type name.
+ * \param [in] mangled the mangled name
+ * \returns the demangled name, or the mangled one if it cannot be demangled
+ */
+std::string
+Demangle(const char* mangled)
+{
+#if (__GNUC__ >= 3)
+    int status;
+    char* demangled = abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+    if (status == 0)
+    {
+        std::string ret = demangled;
+        std::free(demangled);
+        return ret;
+    }
+#endif
+    return mangled;
+}
+
+/**
+ * \ingroup simulator
+ * \brief Remove the template argument lists and the parameter lists
+ * from a qualified name.
+ * \param [in] name the name, e.g., "ns3::A<int>::F(double)"
+ * \returns the name without the lists, e.g., "ns3::A::F"
+ */
+std::string
+StripLists(const std::string& name)
+{
+    std::string ret;
+    int depth = 0;
+    for (char c : name)
+    {
+        if (c == '<' || c == '(')
+        {
+            depth++;
+        }
+        else if (c == '>' || c == ')')
+        {
+            depth--;
+        }
+        else if (depth == 0)
+        {
+            ret += c;
+        }
+    }
+    return ret;
+}
+
+/**
+ * \ingroup simulator
+ * \brief Find the group of a class.
+ * \param [in] className the class name
+ * \param [in] fallback the group of the classes without a TypeId
+ * \returns the TypeId group of the class, or the fallback
+ */
+std::string
+GetGroup(const std::string& className, const std::string& fallback)
+{
+    TypeId tid;
+    if (TypeId::LookupByNameFailSafe(className, &tid) && !tid.GetGroupName().empty())
+    {
+        return tid.GetGroupName();
+    }
+    return fallback;
+}
+
+} // namespace
+
+void
+EventProfiler::Record(const EventImpl* event, uint64_t ns)
+{
+    Entry& entry = m_entries[&typeid(*event)];
+    entry.count++;
+    entry.ns += ns;
+}
+
+EventProfiler::Target
+EventProfiler::GetTarget(const std::type_info* type)
+{
+    NS_LOG_FUNCTION(type);
+    std::string name = Demangle(type->name());
+    // the events of MakeEvent and MakeTimerImpl are local classes of the
+    // function templates, which are instantiated with the type of the
+    // called function: "R (C::*)(Args)" for methods, "R (*)(Args)" for
+    // functions, and the closure type, "F()::{lambda()#1}", for lambdas
+    static const std::regex method(R"(\(([^()*]+)::\*\)\(([^()]*)\))");
+    static const std::regex function(R"(\(\*\)\(([^()]*)\))");
+    static const std::string lambda = "::{lambda";
+    static const std::string makeEvent = "ns3::MakeEvent<";
+    Target target;
+    std::smatch match;
+    if (name.compare(0, makeEvent.size(), makeEvent) == 0 &&
+        name.find(lambda) != std::string::npos)
+    {
+        // a lambda is attributed to the function which defines it, and
+        // to the class of that function, if any
+        std::string definer =
+            StripLists(name.substr(makeEvent.size(), name.find(lambda) - makeEvent.size()));
+        std::size_t scope = definer.rfind("::");
+        target.className = scope == std::string::npos ? "lambda" : definer.substr(0, scope);
+        target.signature = definer + "::{lambda}";
+        target.group = GetGroup(target.className, "(functions)");
+    }
+    else if (std::regex_search(name, match, method))
+    {
+        target.className = match[1];
+        target.signature = target.className + "::*(" + match[2].str() + ")";
+        target.group = GetGroup(target.className, "(no TypeId)");
+    }
+    else if (std::regex_search(name, match, function))
+    {
+        target.group = "(functions)";
+        target.className = "function";
+        target.signature = "(*)(" + match[1].str() + ")";
+    }
+    else
+    {
+        target.group = "(other events)";
+        target.className = name;
+        target.signature = name;
+    }
+    return target;
+}
+
+void
+EventProfiler::Print(std::ostream& os) const
+{
+    NS_LOG_FUNCTION(this);
+    // group the event types by group, then by target, as several types
+    // may have the same target, e.g., events with different bound
+    // argument types
+    std::map<std::string, std::map<std::string, Entry>> groups;
+    uint64_t totalCount = 0;
+    uint64_t totalNs = 0;
+    for (const auto& [type, entry] : m_entries)
+    {
+        Target target = GetTarget(type);
+        Entry& sum = groups[target.group][target.signature];
+        sum.count += entry.count;
+        sum.ns += entry.ns;
+        totalCount += entry.count;
+        totalNs += entry.ns;
+    }
+
+    // sort the groups, and the targets of a group, by decreasing time
+    using Row = std::pair<std::string, Entry>;
+    auto byTime = [](const Row& a, const Row& b) { return a.second.ns > b.second.ns; };
+    std::vector<std::pair<Row, std::vector<Row>>> rows;
+    for (const auto& [group, targets] : groups)
+    {
+        Entry sum{0, 0};
+        std::vector<Row> targetRows(targets.begin(), targets.end());
+        for (const auto& row : targetRows)
+        {
+            sum.count += row.second.count;
+            sum.ns += row.second.ns;
+        }
+        std::sort(targetRows.begin(), targetRows.end(), byTime);
+        rows.emplace_back(Row(group, sum), targetRows);
+    }
+    std::sort(rows.begin(), rows.end(), [&byTime](const auto& a, const auto& b) {
+        return byTime(a.first, b.first);
+    });
+
+    auto printRow = [&os, totalNs](const std::string& name, const Entry& entry) {
+        os << std::setw(12) << entry.count << std::setw(12) << std::fixed << std::setprecision(1)
+           << entry.ns / 1e6 << std::setw(8) << (totalNs ? 100.0 * entry.ns / totalNs : 0.0)
+           << std::setw(10) << std::setprecision(0)
+           << (entry.count ? static_cast<double>(entry.ns) / entry.count : 0.0) << "  " << name
+           << std::endl;
+    };
+    os << std::setw(12) << "events" << std::setw(12) << "time (ms)" << std::setw(8) << "%"
+       << std::setw(10) << "ns/event"
+       << "  group / target" << std::endl;
+    printRow("total", Entry{totalCount, totalNs});
+    for (const auto& [group, targets] : rows)
+    {
+        printRow(group.first, group.second);
+        for (const auto& [name, entry] : targets)
+        {
+            printRow("    " + name, entry);
+        }
+    }
+}
+
+void
+EventProfiler::PrintCollapsed(std::ostream& os) const
+{
+    NS_LOG_FUNCTION(this);
+    std::map<std::string, uint64_t> stacks;
+    for (const auto& [type, entry] : m_entries)
+    {
+        Target target = GetTarget(type);
+        stacks[target.group + ";" + target.className + ";" + target.signature] += entry.ns;
+    }
+    for (const auto& [stack, ns] : stacks)
+    {
+        // flamegraph.pl wants integer weights
+        if (ns >= 1000)
+        {
+            os << stack << " " << ns / 1000 << std::endl;
+        }
+    }
+}
+
+void
+EventProfiler::Write(const std::string& prefix) const
+{
+    NS_LOG_FUNCTION(this << prefix);
+    std::ofstream table(prefix + ".txt");
+    std::ofstream collapsed(prefix + ".folded");
+    if (!table.is_open() || !collapsed.is_open())
+    {
+        NS_FATAL_ERROR("Cannot open the event profile files " << prefix << ".{txt,folded}");
+    }
+    Print(table);
+    PrintCollapsed(collapsed);
+}
+
+} // namespace ns3
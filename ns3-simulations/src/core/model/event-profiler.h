@@ -0,0 +1,118 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+
+/**
+ * \file
+ * \ingroup simulator
+ * ns3::EventProfiler declaration.
+ */
+
+namespace ns3
+{
+
+class EventImpl;
+
+/**
+ * \ingroup simulator
+ *
+ * \brief Attribute the wall clock time of the simulation to the events.
+ *
+ * The simulator implementation times each event it invokes, and records
+ * the time against the type of the event. The events made by MakeEvent
+ * and MakeTimerImpl are of a distinct type for each signature of the
+ * function they call, so the type tells the class of the target object
+ * and the signature of the method, or the function, called by the event.
+ * The class is looked up among the registered TypeIds, to also group the
+ * events by the group of their target, i.e., by module.
+ *
+ * The report is a table of the events, by group then by target, and a
+ * file of collapsed stacks, the input format of flamegraph.pl, whose
+ * frames are the group, the target class, and the called signature.
+ *
+ * The time of an event includes all of the work it does, e.g., the trace
+ * sinks it calls: a Penny callback connected to a net device trace is part
+ * of the time of the net device event which fires the trace.
+ */
+class EventProfiler
+{
+  public:
+    /**
+     * \brief Record the time taken by an event.
+     * \param [in] event the event
+     * \param [in] ns the wall clock time the event took, in nanoseconds
+     */
+    void Record(const EventImpl* event, uint64_t ns);
+
+    /**
+     * \brief Print the table of the events, by group then by target.
+     * \param [in] os the output stream
+     */
+    void Print(std::ostream& os) const;
+    /**
+     * \brief Print the collapsed stacks of the events, weighted by time
+     * in microseconds.
+     * \param [in] os the output stream
+     */
+    void PrintCollapsed(std::ostream& os) const;
+
+    /**
+     * \brief Write the table and the collapsed stacks to files.
+     *
+     * The files are named after the prefix, with the ".txt" and ".folded"
+     * extensions.
+     *
+     * \param [in] prefix the file name prefix
+     */
+    void Write(const std::string& prefix) const;
+
+  private:
+    /// What is known of an event type
+    struct Target
+    {
+        std::string group;     //!< TypeId group of the target class, or its kind
+        std::string className; //!< target class, or kind of event
+        std::string signature; //!< signature of the called function
+    };
+
+    /// The time taken by the events of a type
+    struct Entry
+    {
+        uint64_t count; //!< number of events
+        uint64_t ns;    //!< wall clock time, in nanoseconds
+    };
+
+    /**
+     * \brief Find the target of an event type.
+     * \param [in] type the event type
+     * \returns the target of the events of the type
+     */
+    static Target GetTarget(const std::type_info* type);
+
+    /// The time taken by the events, by event type
+    std::unordered_map<const std::type_info*, Entry> m_entries;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
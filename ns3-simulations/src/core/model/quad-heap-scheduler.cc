@@ -0,0 +1,197 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "quad-heap-scheduler.h"
+
+#include "assert.h"
+#include "event-impl.h"
+#include "log.h"
+
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::QuadHeapScheduler class.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("QuadHeapScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED(QuadHeapScheduler);
+
+namespace
+{
+
+/** Number of children of a node. */
+constexpr std::size_t ARITY = 4;
+
+/**
+ * \param [in] a The first key.
+ * \param [in] b The second key.
+ * \returns \c true if \p a is due before \p b.
+ */
+inline bool
+Before(const Scheduler::EventKey& a, const Scheduler::EventKey& b)
+{
+    return a.m_ts < b.m_ts || (a.m_ts == b.m_ts && a.m_uid < b.m_uid);
+}
+
+} // unnamed namespace
+
+TypeId
+QuadHeapScheduler::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::QuadHeapScheduler")
+                            .SetParent<Scheduler>()
+                            .SetGroupName("Core")
+                            .AddConstructor<QuadHeapScheduler>();
+    return tid;
+}
+
+QuadHeapScheduler::QuadHeapScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+QuadHeapScheduler::~QuadHeapScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+QuadHeapScheduler::SiftUp(std::size_t i, const EventKey& key, EventImpl* impl)
+{
+    while (i > 0)
+    {
+        std::size_t parent = (i - 1) / ARITY;
+        if (!Before(key, m_keys[parent]))
+        {
+            break;
+        }
+        m_keys[i] = m_keys[parent];
+        m_impls[i] = m_impls[parent];
+        i = parent;
+    }
+    m_keys[i] = key;
+    m_impls[i] = impl;
+}
+
+void
+QuadHeapScheduler::SiftDown(std::size_t i, const EventKey& key, EventImpl* impl)
+{
+    std::size_t size = m_keys.size();
+    while (true)
+    {
+        std::size_t first = i * ARITY + 1;
+        if (first >= size)
+        {
+            break;
+        }
+        std::size_t last = std::min(first + ARITY, size);
+        std::size_t min = first;
+        for (std::size_t child = first + 1; child < last; child++)
+        {
+            if (Before(m_keys[child], m_keys[min]))
+            {
+                min = child;
+            }
+        }
+        if (!Before(m_keys[min], key))
+        {
+            break;
+        }
+        m_keys[i] = m_keys[min];
+        m_impls[i] = m_impls[min];
+        i = min;
+    }
+    m_keys[i] = key;
+    m_impls[i] = impl;
+}
+
+void
+QuadHeapScheduler::RemoveAt(std::size_t i)
+{
+    EventKey key = m_keys.back();
+    EventImpl* impl = m_impls.back();
+    m_keys.pop_back();
+    m_impls.pop_back();
+    if (i == m_keys.size())
+    {
+        return;
+    }
+    if (i > 0 && Before(key, m_keys[(i - 1) / ARITY]))
+    {
+        SiftUp(i, key, impl);
+    }
+    else
+    {
+        SiftDown(i, key, impl);
+    }
+}
+
+void
+QuadHeapScheduler::Insert(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    m_keys.emplace_back();
+    m_impls.emplace_back();
+    SiftUp(m_keys.size() - 1, ev.key, ev.impl);
+}
+
+bool
+QuadHeapScheduler::IsEmpty() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_keys.empty();
+}
+
+Scheduler::Event
+QuadHeapScheduler::PeekNext() const
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    return Event{m_impls.front(), m_keys.front()};
+}
+
+Scheduler::Event
+QuadHeapScheduler::RemoveNext()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    Event next{m_impls.front(), m_keys.front()};
+    RemoveAt(0);
+    return next;
+}
+
+void
+QuadHeapScheduler::Remove(const Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    for (std::size_t i = 0; i < m_keys.size(); i++)
+    {
+        if (m_keys[i].m_uid == ev.key.m_uid)
+        {
+            NS_ASSERT(m_impls[i] == ev.impl);
+            RemoveAt(i);
+            return;
+        }
+    }
+    NS_ASSERT(false);
+}
+
+} // namespace ns3
@@ -0,0 +1,116 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef QUAD_HEAP_SCHEDULER_H
+#define QUAD_HEAP_SCHEDULER_H
+
+#include "scheduler.h"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::QuadHeapScheduler class.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief a 4-ary heap event scheduler
+ *
+ * This class implements an event scheduler using an implicit 4-ary
+ * heap, stored in two parallel arrays: the 16-byte event keys, which
+ * are the only data touched while sifting, and the EventImpl pointers.
+ * The four children of a node are adjacent, so that comparing them
+ * reads a single 64-byte run of keys, and the heap is half as deep as
+ * a binary heap.
+ *
+ * Cancelled events stay in the heap until they are removed by the
+ * simulator, as with the other schedulers.
+ *
+ * \par Time Complexity
+ *
+ * Operation    | Amortized %Time  | Reason
+ * :----------- | :--------------- | :-----
+ * Insert()     | Logarithmic      | Sift up
+ * IsEmpty()    | Constant         | Explicit queue size
+ * PeekNext()   | Constant         | Heap kept sorted
+ * Remove()     | Linear           | Search, then sift
+ * RemoveNext() | Logarithmic      | Sift down
+ *
+ * \par Memory Complexity
+ *
+ * Category  | Memory                           | Reason
+ * :-------- | :------------------------------- | :-----
+ * Overhead  | 6 x `sizeof (*)`<br/>(48 bytes)  | Two `std::vector`
+ * Per Event | 0                                | Events stored in `std::vector`
+ * directly
+ *
+ */
+class QuadHeapScheduler : public Scheduler
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    QuadHeapScheduler();
+    /** Destructor. */
+    ~QuadHeapScheduler() override;
+
+    // Inherited
+    void Insert(const Scheduler::Event& ev) override;
+    bool IsEmpty() const override;
+    Scheduler::Event PeekNext() const override;
+    Scheduler::Event RemoveNext() override;
+    void Remove(const Scheduler::Event& ev) override;
+
+  private:
+    /**
+     * Move the entry at index \p i up to its place.
+     * \param [in] i The index of the entry.
+     * \param [in] key The key of the entry.
+     * \param [in] impl The implementation of the entry.
+     */
+    void SiftUp(std::size_t i, const EventKey& key, EventImpl* impl);
+    /**
+     * Move the entry at index \p i down to its place.
+     * \param [in] i The index of the entry.
+     * \param [in] key The key of the entry.
+     * \param [in] impl The implementation of the entry.
+     */
+    void SiftDown(std::size_t i, const EventKey& key, EventImpl* impl);
+    /**
+     * Remove the entry at index \p i.
+     * \param [in] i The index of the entry.
+     */
+    void RemoveAt(std::size_t i);
+
+    /** The event keys, in heap order. */
+    std::vector<EventKey> m_keys;
+    /** The event implementations, parallel to m_keys. */
+    std::vector<EventImpl*> m_impls;
+};
+
+} // namespace ns3
+
+#endif /* QUAD_HEAP_SCHEDULER_H */
@@ -32,6 +32,7 @@
 
 #include "ns3/core-config.h"
 
+#include <chrono>
 #include <cmath>
 #include <fstream>
 #include <iomanip>
@@ -39,6 +40,10 @@
 #include <list>
 #include <vector>
 
+#if defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
 /**
  * \file
  * \ingroup simulator
@@ -92,6 +97,41 @@ PeekImpl()
     return &impl;
 }
 
+/**
+ * \ingroup simulator
+ * \brief Get the statistics of the last run.
+ * \return The statistics.
+ */
+static Simulator::RunStats*
+PeekRunStats()
+{
+    static Simulator::RunStats stats{Time(), 0, 0, 0};
+    return &stats;
+}
+
+/**
+ * \ingroup simulator
+ * \brief Get the peak resident set size of the process.
+ * \return The peak resident set size, in bytes, or 0 if unknown.
+ */
+static uint64_t
+GetPeakMemory()
+{
+#if defined(__linux__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+#ifdef __APPLE__
+        return usage.ru_maxrss;
+#else
+        // Linux reports kilobytes
+        return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+    }
+#endif
+    return 0;
+}
+
 /**
  * \ingroup simulator
  * \brief Get the SimulatorImpl singleton.
@@ -156,6 +196,7 @@ Simulator::Destroy()
     (*pimpl)->Destroy();
     (*pimpl)->Unref();
     *pimpl = nullptr;
+    EventImpl::ReleasePool();
 }
 
 void
@@ -177,7 +218,17 @@ Simulator::Run()
 {
     NS_LOG_FUNCTION_NOARGS();
     Time::ClearMarkedTimes();
-    GetImpl()->Run();
+    SimulatorImpl* impl = GetImpl();
+    uint64_t events = impl->GetEventCount();
+    auto start = std::chrono::steady_clock::now();
+    impl->Run();
+    std::chrono::duration<double> wallClock = std::chrono::steady_clock::now() - start;
+
+    RunStats* stats = PeekRunStats();
+    stats->simTime = impl->Now();
+    stats->wallClock = wallClock.count();
+    stats->events = impl->GetEventCount() - events;
+    stats->peakMemory = GetPeakMemory();
 }
 
 void
@@ -317,6 +368,18 @@ Simulator::GetEventCount()
     return GetImpl()->GetEventCount();
 }
 
+Simulator::RunStats
+Simulator::GetRunStats()
+{
+    return *PeekRunStats();
+}
+
+double
+Simulator::RunStats::GetEventRate() const
+{
+    return wallClock > 0 ? events / wallClock : 0;
+}
+
 uint32_t
 Simulator::GetSystemId()
 {
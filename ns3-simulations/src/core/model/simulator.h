@@ -208,6 +208,34 @@ class Simulator
      */
     static uint64_t GetEventCount();
 
+    /** Performance of the last call to Simulator::Run. */
+    struct RunStats
+    {
+        Time simTime;        //!< Simulation time when Run returned
+        double wallClock;    //!< Wall clock time spent in Run, in seconds
+        uint64_t events;     //!< Number of events executed by Run
+        uint64_t peakMemory; //!< Peak resident set size of the process, in bytes, or 0
+
+        /**
+         * Get the event rate of the run.
+         * \returns The number of events executed per wall clock second.
+         */
+        double GetEventRate() const;
+    };
+
+    /**
+     * Get the performance of the last call to Simulator::Run.
+     *
+     * The statistics are measured around the run of the simulator
+     * implementation, so they cover every simulator implementation.
+     * The peak resident set size is that of the whole process, as
+     * reported by the operating system after the run, and is 0 on the
+     * platforms which do not report it.
+     *
+     * \returns The statistics of the last run, all zero before the first run.
+     */
+    static RunStats GetRunStats();
+
     /**
      * @name Schedule events (in the same context) to run at a future time.
      */
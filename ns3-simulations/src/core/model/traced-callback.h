@@ -22,7 +22,7 @@
 
 #include "callback.h"
 
-#include <list>
+#include <vector>
 
 /**
  * \file
@@ -111,9 +111,12 @@ class TracedCallback
     /**
      * Container type for holding the chain of Callbacks.
      *
+     * A trace source has seldom more than a couple of sinks, so the
+     * chain is a contiguous vector rather than a list.
+     *
      * \tparam Ts \deduced Types of the functor arguments.
      */
-    typedef std::list<Callback<void, Ts...>> CallbackList;
+    typedef std::vector<Callback<void, Ts...>> CallbackList;
     /** The chain of Callbacks. */
     CallbackList m_callbackList;
 };
@@ -193,9 +196,16 @@ template <typename... Ts>
 void
 TracedCallback<Ts...>::operator()(Ts... args) const
 {
-    for (auto i = m_callbackList.begin(); i != m_callbackList.end(); i++)
+    // most trace sources are not connected
+    if (m_callbackList.empty())
+    {
+        return;
+    }
+    // by index, as a Callback may connect another one to this
+    // TracedCallback, and reallocate the vector
+    for (std::size_t i = 0; i < m_callbackList.size(); i++)
     {
-        (*i)(args...);
+        m_callbackList[i](args...);
     }
 }
 
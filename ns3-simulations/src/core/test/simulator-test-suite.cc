@@ -17,13 +17,21 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "ns3/calendar-scheduler.h"
+#include "ns3/config.h"
+#include "ns3/event-impl.h"
 #include "ns3/heap-scheduler.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/priority-queue-scheduler.h"
+#include "ns3/quad-heap-scheduler.h"
 #include "ns3/simulator.h"
+#include "ns3/string.h"
 #include "ns3/test.h"
 
+#include <fstream>
+#include <sstream>
+#include <thread>
+
 using namespace ns3;
 
 /**
@@ -709,6 +717,209 @@ SimulatorTemplateTestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check that the events go back to the event pool, whichever
+ * thread releases them, and that Simulator::Destroy() empties the pool.
+ */
+class SimulatorEventPoolTestCase : public TestCase
+{
+  public:
+    SimulatorEventPoolTestCase();
+    void DoRun() override;
+
+  private:
+    /**
+     * Reschedule itself until \p count reaches zero.
+     * \param count Number of events left.
+     * \param a Unused argument, to vary the size of the events.
+     * \param b Unused argument, to vary the size of the events.
+     */
+    void Chain(int count, double a, uint64_t b);
+    /** Do nothing. */
+    void Nop();
+};
+
+SimulatorEventPoolTestCase::SimulatorEventPoolTestCase()
+    : TestCase("Check the event pool")
+{
+}
+
+void
+SimulatorEventPoolTestCase::Chain(int count, double a, uint64_t b)
+{
+    if (count > 0)
+    {
+        Simulator::Schedule(MicroSeconds(1), &SimulatorEventPoolTestCase::Chain, this, count - 1, a, b);
+        Simulator::Schedule(MicroSeconds(2), &SimulatorEventPoolTestCase::Nop, this);
+    }
+}
+
+void
+SimulatorEventPoolTestCase::Nop()
+{
+}
+
+void
+SimulatorEventPoolTestCase::DoRun()
+{
+    EventImpl::PoolStats before = EventImpl::GetPoolStats();
+
+    Simulator::Schedule(Seconds(0), &SimulatorEventPoolTestCase::Chain, this, 10000, 0.0, 0);
+    EventId cancelled = Simulator::Schedule(Seconds(1), &SimulatorEventPoolTestCase::Nop, this);
+    cancelled.Cancel();
+    // released by another thread
+    EventId remote = Simulator::Schedule(Seconds(1), &SimulatorEventPoolTestCase::Nop, this);
+    Simulator::Run();
+    std::thread([&remote]() { remote = EventId(); }).join();
+    cancelled = EventId();
+
+    EventImpl::PoolStats after = EventImpl::GetPoolStats();
+    NS_TEST_EXPECT_MSG_EQ(after.live, before.live, "Events were not released");
+    Simulator::Destroy();
+    if (before.live == 0)
+    {
+        NS_TEST_EXPECT_MSG_EQ(EventImpl::GetPoolStats().slabs, 0, "Pool was not emptied");
+    }
+}
+
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check that the event profile attributes the events to their
+ * target, in the table and in the collapsed stacks.
+ */
+class SimulatorEventProfileTestCase : public TestCase
+{
+  public:
+    SimulatorEventProfileTestCase();
+    void DoRun() override;
+
+  private:
+    /** Do nothing. */
+    static void Nop();
+};
+
+SimulatorEventProfileTestCase::SimulatorEventProfileTestCase()
+    : TestCase("Check the event profile")
+{
+}
+
+void
+SimulatorEventProfileTestCase::Nop()
+{
+}
+
+void
+SimulatorEventProfileTestCase::DoRun()
+{
+    std::string prefix = CreateTempDirFilename("event-profile");
+    Config::SetDefault("ns3::DefaultSimulatorImpl::EventProfile", StringValue(prefix));
+    Ptr<Object> object = CreateObject<Object>();
+    for (int i = 0; i < 3; i++)
+    {
+        Simulator::Schedule(Seconds(i), &Object::Initialize, object);
+    }
+    Simulator::Schedule(Seconds(1), &SimulatorEventProfileTestCase::Nop);
+    Simulator::Schedule(Seconds(2), []() { Nop(); });
+    Simulator::Run();
+    Simulator::Destroy();
+    Config::SetDefault("ns3::DefaultSimulatorImpl::EventProfile", StringValue(""));
+
+    std::ifstream table(prefix + ".txt");
+    NS_TEST_ASSERT_MSG_EQ(table.is_open(), true, "Profile table not written");
+    std::stringstream text;
+    text << table.rdbuf();
+    std::string line;
+    bool total = false;
+    bool core = false;
+    bool initialize = false;
+    while (std::getline(text, line))
+    {
+        std::istringstream row(line);
+        uint64_t events;
+        std::string name;
+        if (!(row >> events))
+        {
+            continue;
+        }
+        name = line.substr(line.find_last_of(' ') + 1);
+        total |= name == "total" && events == 5;
+        core |= name == "Core" && events == 3;
+        initialize |= name == "ns3::Object::*()" && events == 3;
+    }
+    NS_TEST_EXPECT_MSG_EQ(total, true, "Wrong total in the table:\n" << text.str());
+    NS_TEST_EXPECT_MSG_EQ(core, true, "Wrong Core group in the table:\n" << text.str());
+    NS_TEST_EXPECT_MSG_EQ(initialize, true, "Wrong Object target in the table:\n" << text.str());
+
+    // the collapsed stacks have one line per target, with its time in
+    // microseconds, unless it is below a microsecond
+    std::ifstream collapsed(prefix + ".folded");
+    NS_TEST_ASSERT_MSG_EQ(collapsed.is_open(), true, "Collapsed stacks not written");
+    while (std::getline(collapsed, line))
+    {
+        std::string stack = line.substr(0, line.find_last_of(' '));
+        NS_TEST_EXPECT_MSG_EQ((stack == "Core;ns3::Object;ns3::Object::*()" ||
+                               stack == "(functions);function;(*)()" ||
+                               stack == "(functions);SimulatorEventProfileTestCase;"
+                                        "SimulatorEventProfileTestCase::DoRun::{lambda}"),
+                              true,
+                              "Unexpected stack " << line);
+    }
+}
+
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check the statistics of the runs of the simulator.
+ */
+class SimulatorRunStatsTestCase : public TestCase
+{
+  public:
+    SimulatorRunStatsTestCase();
+    void DoRun() override;
+
+  private:
+    /** Do nothing. */
+    static void Nop();
+};
+
+SimulatorRunStatsTestCase::SimulatorRunStatsTestCase()
+    : TestCase("Check the run statistics")
+{
+}
+
+void
+SimulatorRunStatsTestCase::Nop()
+{
+}
+
+void
+SimulatorRunStatsTestCase::DoRun()
+{
+    for (int i = 0; i < 100; i++)
+    {
+        Simulator::Schedule(MilliSeconds(i), &SimulatorRunStatsTestCase::Nop);
+    }
+    Simulator::Run();
+    Simulator::RunStats stats = Simulator::GetRunStats();
+    NS_TEST_EXPECT_MSG_EQ(stats.events, 100, "Wrong number of events");
+    NS_TEST_EXPECT_MSG_EQ(stats.simTime, MilliSeconds(99), "Wrong simulation time");
+    NS_TEST_EXPECT_MSG_GT_OR_EQ(stats.wallClock, 0, "Negative wall clock time");
+#ifdef __linux__
+    NS_TEST_EXPECT_MSG_GT(stats.peakMemory, 0, "Peak memory not reported");
+#endif
+
+    // a run only counts its own events
+    Simulator::Schedule(Seconds(1), &SimulatorRunStatsTestCase::Nop);
+    Simulator::Run();
+    stats = Simulator::GetRunStats();
+    NS_TEST_EXPECT_MSG_EQ(stats.events, 1, "Events of the previous run counted");
+    NS_TEST_EXPECT_MSG_EQ(stats.simTime, MilliSeconds(1099), "Wrong simulation time");
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup simulator-tests
  *
@@ -732,6 +943,11 @@ class SimulatorTestSuite : public TestSuite
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
         factory.SetTypeId(PriorityQueueScheduler::GetTypeId());
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
+        factory.SetTypeId(QuadHeapScheduler::GetTypeId());
+        AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
+        AddTestCase(new SimulatorEventPoolTestCase(), TestCase::QUICK);
+        AddTestCase(new SimulatorEventProfileTestCase(), TestCase::QUICK);
+        AddTestCase(new SimulatorRunStatsTestCase(), TestCase::QUICK);
     }
 };
 
@@ -132,6 +132,21 @@ BasicTracedCallbackTestCase::DoRun()
     trace(1, 2);
     NS_TEST_ASSERT_MSG_EQ(m_one, true, "Callback CbOne not called");
     NS_TEST_ASSERT_MSG_EQ(m_two, true, "Callback CbTwo not called");
+
+    //
+    // A callback may connect other callbacks to the traced callback it is
+    // called from. They are called by the same hit of the trace.
+    //
+    uint32_t calls = 0;
+    trace.ConnectWithoutContext(Callback<void, uint8_t, double>([&](uint8_t, double) {
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            trace.ConnectWithoutContext(
+                Callback<void, uint8_t, double>([&calls](uint8_t, double) { calls++; }));
+        }
+    }));
+    trace(1, 2);
+    NS_TEST_ASSERT_MSG_EQ(calls, 16, "Callbacks connected by a callback not called");
 }
 
 /**
@@ -0,0 +1,157 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/network-module.h"
+#include "ns3/point-to-point-module.h"
+
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup globalrouting
+ * Benchmark of the Ipv4GlobalRouting lookups on a generated topology.
+ *
+ * The routers form a ring, with random chords added until the average
+ * degree is reached. Each link is a /30 subnet, and each router has a
+ * /24 stub network. Once the global routes are computed, the benchmark
+ * times the output route lookups of random routers toward random
+ * addresses of the topology.
+ *
+ * \code
+ *   ./ns3 run "bench-global-routing --routers=400 --degree=4"
+ * \endcode
+ */
+
+using namespace ns3;
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t routers = 200;
+    double degree = 4;
+    uint32_t lookups = 1000000;
+    bool ecmp = false;
+
+    CommandLine cmd(__FILE__);
+    cmd.Usage("Benchmark of the global routing lookups on a generated topology.");
+    cmd.AddValue("routers", "Number of routers", routers);
+    cmd.AddValue("degree", "Average degree of the routers", degree);
+    cmd.AddValue("lookups", "Number of route lookups", lookups);
+    cmd.AddValue("ecmp", "Pick the route at random among the equal cost routes", ecmp);
+    cmd.Parse(argc, argv);
+
+    Config::SetDefault("ns3::Ipv4GlobalRouting::RandomEcmpRouting", BooleanValue(ecmp));
+    RngSeedManager::SetSeed(1);
+    Ptr<UniformRandomVariable> random = CreateObject<UniformRandomVariable>();
+
+    NodeContainer nodes;
+    nodes.Create(routers);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+
+    // ring, then random chords
+    std::set<std::pair<uint32_t, uint32_t>> links;
+    for (uint32_t i = 0; i < routers; i++)
+    {
+        links.emplace(std::min(i, (i + 1) % routers), std::max(i, (i + 1) % routers));
+    }
+    auto nLinks = static_cast<std::size_t>(routers * degree / 2);
+    while (links.size() < nLinks)
+    {
+        uint32_t a = random->GetInteger(0, routers - 1);
+        uint32_t b = random->GetInteger(0, routers - 1);
+        if (a != b)
+        {
+            links.emplace(std::min(a, b), std::max(a, b));
+        }
+    }
+
+    PointToPointHelper p2p;
+    p2p.SetChannelAttribute("Delay", StringValue("1ms"));
+    Ipv4AddressHelper address("10.0.0.0", "255.255.255.252");
+    std::vector<Ipv4Address> destinations;
+    for (const auto& [a, b] : links)
+    {
+        NetDeviceContainer devices = p2p.Install(nodes.Get(a), nodes.Get(b));
+        Ipv4InterfaceContainer interfaces = address.Assign(devices);
+        address.NewNetwork();
+        destinations.push_back(interfaces.GetAddress(1));
+    }
+
+    // a stub network per router, on a device without peer
+    Ipv4AddressHelper stub("172.16.0.0", "255.255.255.0");
+    for (uint32_t i = 0; i < routers; i++)
+    {
+        Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice>();
+        device->SetAddress(Mac48Address::Allocate());
+        nodes.Get(i)->AddDevice(device);
+        Ipv4InterfaceContainer interfaces = stub.Assign(NetDeviceContainer(device));
+        stub.NewNetwork();
+        destinations.push_back(Ipv4Address(interfaces.GetAddress(0).Get() + 1));
+    }
+
+    SystemWallClockMs timer;
+    timer.Start();
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    int64_t populateMs = timer.End();
+
+    std::vector<Ptr<Ipv4RoutingProtocol>> protocols;
+    uint64_t nRoutes = 0;
+    for (uint32_t i = 0; i < routers; i++)
+    {
+        Ptr<Ipv4> ipv4 = nodes.Get(i)->GetObject<Ipv4>();
+        Ptr<Ipv4GlobalRouting> global =
+            Ipv4RoutingHelper::GetRouting<Ipv4GlobalRouting>(ipv4->GetRoutingProtocol());
+        nRoutes += global->GetNRoutes();
+        protocols.push_back(global);
+    }
+
+    // draw the lookups first, not to time the random variable
+    std::vector<std::pair<uint32_t, uint32_t>> draws(lookups);
+    for (auto& draw : draws)
+    {
+        draw.first = random->GetInteger(0, routers - 1);
+        draw.second = random->GetInteger(0, destinations.size() - 1);
+    }
+
+    uint64_t found = 0;
+    Ipv4Header header;
+    Socket::SocketErrno sockerr;
+    timer.Start();
+    for (const auto& [router, destination] : draws)
+    {
+        header.SetDestination(destinations[destination]);
+        if (protocols[router]->RouteOutput(nullptr, header, nullptr, sockerr))
+        {
+            found++;
+        }
+    }
+    int64_t lookupMs = timer.End();
+
+    std::cout << "routers " << routers << ", links " << links.size() << ", routes per router "
+              << nRoutes / routers << std::endl;
+    std::cout << "populate " << populateMs << " ms" << std::endl;
+    std::cout << "lookups " << lookups << " (" << found << " routed) in " << lookupMs << " ms, "
+              << std::fixed << std::setprecision(0)
+              << (lookupMs > 0 ? lookups * 1000.0 / lookupMs : 0) << " lookups/s" << std::endl;
+
+    Simulator::Destroy();
+    return 0;
+}
@@ -39,6 +39,7 @@ namespace ns3
 const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
+class Ipv4;
 class Ipv4GlobalRouting;
 
 /**
@@ -743,8 +744,35 @@ class GlobalRouteManagerImpl
     void DebugSPFCalculate(Ipv4Address root);
 
   private:
+    /// A router for which the routes are calculated
+    struct SPFRoot
+    {
+        Ipv4Address routerId;           //!< the router ID
+        Ptr<Ipv4> ipv4;                 //!< the Ipv4 of the router
+        Ptr<Ipv4GlobalRouting> routing; //!< the routing protocol of the router
+    };
+
     SPFVertex* m_spfroot;           //!< the root node
     GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+    Ptr<Ipv4> m_spfrootIpv4;        //!< the Ipv4 of the root node, if found
+    Ptr<Ipv4GlobalRouting> m_spfrootRouting; //!< the routing protocol of the root node, if found
+
+    /**
+     * \brief Insert the LSAs discovered by the routers into a database.
+     *
+     * \param routers the routers
+     * \param lsdb the database
+     */
+    static void InsertLSAs(const std::vector<Ptr<GlobalRouter>>& routers,
+                           GlobalRouteManagerLSDB* lsdb);
+
+    /**
+     * \brief Calculate the shortest path first (SPF) tree of a router and
+     * write its routes.
+     *
+     * \param root the router
+     */
+    void SPFCalculate(const SPFRoot& root);
 
     /**
      * \brief Test if a node is a stub, from an OSPF sense.
@@ -43,30 +43,112 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux()
     for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
     {
         Ipv4EndPoint* endPoint = *i;
+        endPoint->m_demux = nullptr;
         delete endPoint;
     }
     m_endPoints.clear();
+    m_ports.clear();
+    m_listening.clear();
+    m_connected.clear();
 }
 
 bool
-Ipv4EndPointDemux::LookupPortLocal(uint16_t port)
+Ipv4EndPointDemux::FourTuple::operator==(const FourTuple& other) const
 {
-    NS_LOG_FUNCTION(this << port);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    return localAddress == other.localAddress && peerAddress == other.peerAddress &&
+           localPort == other.localPort && peerPort == other.peerPort;
+}
+
+std::size_t
+Ipv4EndPointDemux::FourTupleHash::operator()(const FourTuple& tuple) const
+{
+    uint64_t addresses = (static_cast<uint64_t>(tuple.localAddress) << 32) | tuple.peerAddress;
+    uint64_t ports = (static_cast<uint64_t>(tuple.localPort) << 16) | tuple.peerPort;
+    // the connections of a host differ in few bits, so mix them all
+    uint64_t hash = (addresses ^ (ports * 0x9e3779b97f4a7c15ULL)) * 0xff51afd7ed558ccdULL;
+    return hash ^ (hash >> 32);
+}
+
+bool
+Ipv4EndPointDemux::IsConnected(Ipv4Address localAddress, Ipv4Address peerAddress, uint16_t peerPort)
+{
+    return localAddress != Ipv4Address::GetAny() && peerAddress != Ipv4Address::GetAny() &&
+           peerPort != 0;
+}
+
+void
+Ipv4EndPointDemux::Insert(Ipv4EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    endPoint->m_demux = this;
+    m_endPoints.push_back(endPoint);
+    m_ports[endPoint->m_localPort].push_back(endPoint);
+    Index(endPoint);
+    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
+}
+
+void
+Ipv4EndPointDemux::Index(Ipv4EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    if (IsConnected(endPoint->m_localAddr, endPoint->m_peerAddr, endPoint->m_peerPort))
+    {
+        m_connected[{endPoint->m_localAddr.Get(),
+                     endPoint->m_peerAddr.Get(),
+                     endPoint->m_localPort,
+                     endPoint->m_peerPort}]
+            .push_back(endPoint);
+    }
+    else
+    {
+        m_listening[endPoint->m_localPort].push_back(endPoint);
+    }
+}
+
+void
+Ipv4EndPointDemux::Unindex(Ipv4EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    if (IsConnected(endPoint->m_localAddr, endPoint->m_peerAddr, endPoint->m_peerPort))
     {
-        if ((*i)->GetLocalPort() == port)
+        auto i = m_connected.find({endPoint->m_localAddr.Get(),
+                                   endPoint->m_peerAddr.Get(),
+                                   endPoint->m_localPort,
+                                   endPoint->m_peerPort});
+        i->second.remove(endPoint);
+        if (i->second.empty())
         {
-            return true;
+            m_connected.erase(i);
         }
     }
-    return false;
+    else
+    {
+        auto i = m_listening.find(endPoint->m_localPort);
+        i->second.remove(endPoint);
+        if (i->second.empty())
+        {
+            m_listening.erase(i);
+        }
+    }
+}
+
+bool
+Ipv4EndPointDemux::LookupPortLocal(uint16_t port)
+{
+    NS_LOG_FUNCTION(this << port);
+    return m_ports.find(port) != m_ports.end();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal(Ptr<NetDevice> boundNetDevice, Ipv4Address addr, uint16_t port)
 {
     NS_LOG_FUNCTION(this << addr << port);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto bucket = m_ports.find(port);
+    if (bucket == m_ports.end())
+    {
+        return false;
+    }
+    for (auto i = bucket->second.begin(); i != bucket->second.end(); i++)
     {
         if ((*i)->GetLocalPort() == port && (*i)->GetLocalAddress() == addr &&
             (*i)->GetBoundNetDevice() == boundNetDevice)
@@ -88,8 +170,7 @@ Ipv4EndPointDemux::Allocate()
         return nullptr;
     }
     auto endPoint = new Ipv4EndPoint(Ipv4Address::GetAny(), port);
-    m_endPoints.push_back(endPoint);
-    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
+    Insert(endPoint);
     return endPoint;
 }
 
@@ -104,8 +185,7 @@ Ipv4EndPointDemux::Allocate(Ipv4Address address)
         return nullptr;
     }
     auto endPoint = new Ipv4EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
-    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
+    Insert(endPoint);
     return endPoint;
 }
 
@@ -127,8 +207,7 @@ Ipv4EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice, Ipv4Address address,
         return nullptr;
     }
     auto endPoint = new Ipv4EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
-    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
+    Insert(endPoint);
     return endPoint;
 }
 
@@ -140,21 +219,34 @@ Ipv4EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice,
                             uint16_t peerPort)
 {
     NS_LOG_FUNCTION(this << localAddress << localPort << peerAddress << peerPort << boundNetDevice);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    // the duplicates are in the same index as the new endpoint
+    const EndPoints* duplicates = nullptr;
+    if (IsConnected(localAddress, peerAddress, peerPort))
+    {
+        auto i = m_connected.find({localAddress.Get(), peerAddress.Get(), localPort, peerPort});
+        duplicates = i != m_connected.end() ? &i->second : nullptr;
+    }
+    else
+    {
+        auto i = m_listening.find(localPort);
+        duplicates = i != m_listening.end() ? &i->second : nullptr;
+    }
+    if (duplicates)
     {
-        if ((*i)->GetLocalPort() == localPort && (*i)->GetLocalAddress() == localAddress &&
-            (*i)->GetPeerPort() == peerPort && (*i)->GetPeerAddress() == peerAddress &&
-            ((*i)->GetBoundNetDevice() == boundNetDevice || !(*i)->GetBoundNetDevice()))
+        for (auto i = duplicates->begin(); i != duplicates->end(); i++)
         {
-            NS_LOG_WARN("Duplicated endpoint.");
-            return nullptr;
+            if ((*i)->GetLocalPort() == localPort && (*i)->GetLocalAddress() == localAddress &&
+                (*i)->GetPeerPort() == peerPort && (*i)->GetPeerAddress() == peerAddress &&
+                ((*i)->GetBoundNetDevice() == boundNetDevice || !(*i)->GetBoundNetDevice()))
+            {
+                NS_LOG_WARN("Duplicated endpoint.");
+                return nullptr;
+            }
         }
     }
     auto endPoint = new Ipv4EndPoint(localAddress, localPort);
     endPoint->SetPeer(peerAddress, peerPort);
-    m_endPoints.push_back(endPoint);
-
-    NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
+    Insert(endPoint);
 
     return endPoint;
 }
@@ -167,8 +259,16 @@ Ipv4EndPointDemux::DeAllocate(Ipv4EndPoint* endPoint)
     {
         if (*i == endPoint)
         {
-            delete endPoint;
+            Unindex(endPoint);
+            auto bucket = m_ports.find(endPoint->m_localPort);
+            bucket->second.remove(endPoint);
+            if (bucket->second.empty())
+            {
+                m_ports.erase(bucket);
+            }
             m_endPoints.erase(i);
+            endPoint->m_demux = nullptr;
+            delete endPoint;
             break;
         }
     }
@@ -211,10 +311,7 @@ Ipv4EndPointDemux::Lookup(Ipv4Address daddr,
     EndPoints retval4; // Exact match on all 4
 
     NS_LOG_DEBUG("Looking up endpoint for destination address " << daddr << ":" << dport);
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
-    {
-        Ipv4EndPoint* endP = *i;
-
+    auto match = [&](Ipv4EndPoint* endP) {
         NS_LOG_DEBUG("Looking at endpoint dport="
                      << endP->GetLocalPort() << " daddr=" << endP->GetLocalAddress()
                      << " sport=" << endP->GetPeerPort() << " saddr=" << endP->GetPeerAddress());
@@ -223,7 +320,7 @@ Ipv4EndPointDemux::Lookup(Ipv4Address daddr,
         {
             NS_LOG_LOGIC("Skipping endpoint " << &endP
                                               << " because endpoint can not receive packets");
-            continue;
+            return;
         }
 
         if (endP->GetLocalPort() != dport)
@@ -231,7 +328,7 @@ Ipv4EndPointDemux::Lookup(Ipv4Address daddr,
             NS_LOG_LOGIC("Skipping endpoint " << &endP << " because endpoint dport "
                                               << endP->GetLocalPort()
                                               << " does not match packet dport " << dport);
-            continue;
+            return;
         }
         if (endP->GetBoundNetDevice())
         {
@@ -241,7 +338,7 @@ Ipv4EndPointDemux::Lookup(Ipv4Address daddr,
                              << &endP << " because endpoint is bound to specific device and"
                              << endP->GetBoundNetDevice() << " does not match packet device "
                              << incomingInterface->GetDevice());
-                continue;
+                return;
             }
         }
 
@@ -290,7 +387,7 @@ Ipv4EndPointDemux::Lookup(Ipv4Address daddr,
             // if no match here, keep looking
             if (!localAddressIsSubnetAny)
             {
-                continue;
+                return;
             }
         }
 
@@ -303,11 +400,11 @@ Ipv4EndPointDemux::Lookup(Ipv4Address daddr,
         // skip this one
         if (!(remotePortMatchesExact || remotePortMatchesWildCard))
         {
-            continue;
+            return;
         }
         if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
         {
-            continue;
+            return;
         }
 
         bool localAddressMatchesWildCard = localAddressIsAny || localAddressIsSubnetAny;
@@ -342,6 +439,47 @@ Ipv4EndPointDemux::Lookup(Ipv4Address daddr,
                                                                  << endP->GetLocalPort());
             retval1.push_back(endP);
         }
+    };
+
+    // the connected endpoints which can match are those of the four-tuple
+    // of the packet, and those bound to the subnet of the destination, see
+    // case 3 above; the other endpoints are those of the destination port
+    auto matchConnected = [&](Ipv4Address local) {
+        auto connected = m_connected.find({local.Get(), saddr.Get(), dport, sport});
+        if (connected != m_connected.end())
+        {
+            for (auto endP : connected->second)
+            {
+                match(endP);
+            }
+        }
+    };
+    if (!m_connected.empty())
+    {
+        matchConnected(daddr);
+        for (uint32_t i = 0; i < incomingInterface->GetNAddresses(); i++)
+        {
+            Ipv4InterfaceAddress addr = incomingInterface->GetAddress(i);
+            Ipv4Address addrNetpart = addr.GetLocal().CombineMask(addr.GetMask());
+            bool seen = addrNetpart == daddr;
+            for (uint32_t j = 0; j < i && !seen; j++)
+            {
+                Ipv4InterfaceAddress other = incomingInterface->GetAddress(j);
+                seen = other.GetLocal().CombineMask(other.GetMask()) == addrNetpart;
+            }
+            if (!seen && daddr.CombineMask(addr.GetMask()) == addrNetpart)
+            {
+                matchConnected(addrNetpart);
+            }
+        }
+    }
+    auto listening = m_listening.find(dport);
+    if (listening != m_listening.end())
+    {
+        for (auto endP : listening->second)
+        {
+            match(endP);
+        }
     }
 
     // Here we find the most exact match
@@ -382,7 +520,12 @@ Ipv4EndPointDemux::SimpleLookup(Ipv4Address daddr,
     // function.
     uint32_t genericity = 3;
     Ipv4EndPoint* generic = nullptr;
-    for (auto i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto bucket = m_ports.find(dport);
+    if (bucket == m_ports.end())
+    {
+        return nullptr;
+    }
+    for (auto i = bucket->second.begin(); i != bucket->second.end(); i++)
     {
         if ((*i)->GetLocalPort() != dport)
         {
@@ -26,6 +26,7 @@
 
 #include <list>
 #include <stdint.h>
+#include <unordered_map>
 
 namespace ns3
 {
@@ -42,6 +43,16 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints are indexed, so that a lookup does not depend on the
+ * number of endpoints: the connected endpoints, i.e., those with a local
+ * address, a peer address and a peer port, are hashed by their four-tuple,
+ * and the other endpoints, e.g., the listening ones, by their local port.
+ * A lookup only examines the connected endpoints which can match the
+ * four-tuple of the packet, and the other endpoints of the destination
+ * port, so the precedence among the matching endpoints is unchanged.
+ * The endpoints tell the demux when their addresses change, to be indexed
+ * again.
  */
 
 class Ipv4EndPointDemux
@@ -177,6 +188,69 @@ class Ipv4EndPointDemux
      */
     uint16_t AllocateEphemeralPort();
 
+    friend class Ipv4EndPoint;
+
+    /**
+     * \brief Four-tuple of a connected endpoint.
+     */
+    struct FourTuple
+    {
+        uint32_t localAddress; //!< local address
+        uint32_t peerAddress;  //!< peer address
+        uint16_t localPort;    //!< local port
+        uint16_t peerPort;     //!< peer port
+
+        /**
+         * \brief Equality operator.
+         * \param other the four-tuple to compare with
+         * \return true if the four-tuples are equal
+         */
+        bool operator==(const FourTuple& other) const;
+    };
+
+    /**
+     * \brief Hash of a four-tuple.
+     */
+    struct FourTupleHash
+    {
+        /**
+         * \brief Hash a four-tuple.
+         * \param tuple the four-tuple
+         * \return the hash
+         */
+        std::size_t operator()(const FourTuple& tuple) const;
+    };
+
+    /**
+     * \brief Check if an endpoint is connected, i.e., indexed by its four-tuple.
+     * \param localAddress the local address of the endpoint
+     * \param peerAddress the peer address of the endpoint
+     * \param peerPort the peer port of the endpoint
+     * \return true if the endpoint has a local address, a peer address and a peer port
+     */
+    static bool IsConnected(Ipv4Address localAddress, Ipv4Address peerAddress, uint16_t peerPort);
+
+    /**
+     * \brief Add a new endpoint to the demux.
+     * \param endPoint the endpoint
+     */
+    void Insert(Ipv4EndPoint* endPoint);
+
+    /**
+     * \brief Index an endpoint by its addresses and ports.
+     * \param endPoint the endpoint
+     */
+    void Index(Ipv4EndPoint* endPoint);
+
+    /**
+     * \brief Remove an endpoint from the index of its addresses and ports.
+     *
+     * This is called by the endpoint before its addresses change.
+     *
+     * \param endPoint the endpoint
+     */
+    void Unindex(Ipv4EndPoint* endPoint);
+
     /**
      * \brief The ephemeral port.
      */
@@ -196,6 +270,21 @@ class Ipv4EndPointDemux
      * \brief A list of IPv4 end points.
      */
     EndPoints m_endPoints;
+
+    /**
+     * \brief The end points, by local port.
+     */
+    std::unordered_map<uint16_t, EndPoints> m_ports;
+
+    /**
+     * \brief The end points which are not connected, by local port.
+     */
+    std::unordered_map<uint16_t, EndPoints> m_listening;
+
+    /**
+     * \brief The connected end points, by four-tuple.
+     */
+    std::unordered_map<FourTuple, EndPoints, FourTupleHash> m_connected;
 };
 
 } // namespace ns3
@@ -30,6 +30,7 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 
+#include <algorithm>
 #include <iomanip>
 #include <vector>
 
@@ -66,7 +67,8 @@ Ipv4GlobalRouting::GetTypeId()
 
 Ipv4GlobalRouting::Ipv4GlobalRouting()
     : m_randomEcmpRouting(false),
-      m_respondToInterfaceEvents(false)
+      m_respondToInterfaceEvents(false),
+      m_indexValid(false)
 {
     NS_LOG_FUNCTION(this);
 
@@ -85,6 +87,7 @@ Ipv4GlobalRouting::AddHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateHostRouteTo(dest, nextHop, interface);
     m_hostRoutes.push_back(route);
+    m_indexValid = false;
 }
 
 void
@@ -94,6 +97,7 @@ Ipv4GlobalRouting::AddHostRouteTo(Ipv4Address dest, uint32_t interface)
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateHostRouteTo(dest, interface);
     m_hostRoutes.push_back(route);
+    m_indexValid = false;
 }
 
 void
@@ -106,6 +110,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo(Ipv4Address network,
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
     m_networkRoutes.push_back(route);
+    m_indexValid = false;
 }
 
 void
@@ -115,6 +120,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkMask,
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, interface);
     m_networkRoutes.push_back(route);
+    m_indexValid = false;
 }
 
 void
@@ -127,6 +133,62 @@ Ipv4GlobalRouting::AddASExternalRouteTo(Ipv4Address network,
     auto route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
     m_ASexternalRoutes.push_back(route);
+    m_indexValid = false;
+}
+
+void
+Ipv4GlobalRouting::RouteIndex::Build(const std::list<Ipv4RoutingTableEntry*>& routes, bool host)
+{
+    m_masks.clear();
+    uint32_t position = 0;
+    for (auto route : routes)
+    {
+        uint32_t mask = host ? Ipv4Mask::GetOnes().Get() : route->GetDestNetworkMask().Get();
+        uint32_t dest = host ? route->GetDest().Get() : route->GetDestNetwork().Get() & mask;
+        auto it = std::find_if(m_masks.begin(), m_masks.end(), [mask](const auto& routes) {
+            return routes.first == mask;
+        });
+        if (it == m_masks.end())
+        {
+            it = m_masks.emplace(m_masks.end(), mask, Routes());
+        }
+        it->second[dest].emplace_back(position++, route);
+    }
+}
+
+void
+Ipv4GlobalRouting::RouteIndex::Lookup(Ipv4Address dest, std::vector<Entry>& matches) const
+{
+    std::size_t begin = matches.size();
+    uint32_t nMasks = 0;
+    for (const auto& [mask, routes] : m_masks)
+    {
+        auto it = routes.find(dest.Get() & mask);
+        if (it != routes.end())
+        {
+            matches.insert(matches.end(), it->second.begin(), it->second.end());
+            nMasks++;
+        }
+    }
+    if (nMasks > 1)
+    {
+        std::sort(matches.begin() + begin, matches.end());
+    }
+}
+
+void
+Ipv4GlobalRouting::FilterInterface(std::vector<RouteIndex::Entry>& matches,
+                                   Ptr<NetDevice> oif) const
+{
+    if (!oif)
+    {
+        return;
+    }
+    auto end = std::remove_if(matches.begin(), matches.end(), [&](const RouteIndex::Entry& entry) {
+        return oif != m_ipv4->GetNetDevice(entry.second->GetInterface());
+    });
+    NS_LOG_LOGIC("Skipping " << matches.end() - end << " routes not on requested interface");
+    matches.erase(end, matches.end());
 }
 
 Ptr<Ipv4Route>
@@ -135,70 +197,40 @@ Ipv4GlobalRouting::LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif)
     NS_LOG_FUNCTION(this << dest << oif);
     NS_LOG_LOGIC("Looking for route for destination " << dest);
     Ptr<Ipv4Route> rtentry = nullptr;
-    // store all available routes that bring packets to their destination
-    typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
-    RouteVec_t allRoutes;
 
-    NS_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
-    for (auto i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
+    // The indexes are rebuilt on the first lookup after a change of the
+    // routes, GlobalRouteManager adding the routes one by one.
+    if (!m_indexValid)
     {
-        NS_ASSERT((*i)->IsHost());
-        if ((*i)->GetDest() == dest)
-        {
-            if (oif)
-            {
-                if (oif != m_ipv4->GetNetDevice((*i)->GetInterface()))
-                {
-                    NS_LOG_LOGIC("Not on requested interface, skipping");
-                    continue;
-                }
-            }
-            allRoutes.push_back(*i);
-            NS_LOG_LOGIC(allRoutes.size() << "Found global host route" << *i);
-        }
+        m_hostIndex.Build(m_hostRoutes, true);
+        m_networkIndex.Build(m_networkRoutes, false);
+        m_ASexternalIndex.Build(m_ASexternalRoutes, false);
+        m_indexValid = true;
     }
+
+    // store all available routes that bring packets to their destination
+    std::vector<RouteIndex::Entry>& allRoutes = m_matches;
+    allRoutes.clear();
+
+    NS_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
+    m_hostIndex.Lookup(dest, allRoutes);
+    FilterInterface(allRoutes, oif);
+    NS_LOG_LOGIC("Found " << allRoutes.size() << " global host routes");
     if (allRoutes.empty()) // if no host route is found
     {
         NS_LOG_LOGIC("Number of m_networkRoutes" << m_networkRoutes.size());
-        for (auto j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
-        {
-            Ipv4Mask mask = (*j)->GetDestNetworkMask();
-            Ipv4Address entry = (*j)->GetDestNetwork();
-            if (mask.IsMatch(dest, entry))
-            {
-                if (oif)
-                {
-                    if (oif != m_ipv4->GetNetDevice((*j)->GetInterface()))
-                    {
-                        NS_LOG_LOGIC("Not on requested interface, skipping");
-                        continue;
-                    }
-                }
-                allRoutes.push_back(*j);
-                NS_LOG_LOGIC(allRoutes.size() << "Found global network route" << *j);
-            }
-        }
+        m_networkIndex.Lookup(dest, allRoutes);
+        FilterInterface(allRoutes, oif);
+        NS_LOG_LOGIC("Found " << allRoutes.size() << " global network routes");
     }
     if (allRoutes.empty()) // consider external if no host/network found
     {
-        for (auto k = m_ASexternalRoutes.begin(); k != m_ASexternalRoutes.end(); k++)
+        m_ASexternalIndex.Lookup(dest, allRoutes);
+        FilterInterface(allRoutes, oif);
+        if (!allRoutes.empty())
         {
-            Ipv4Mask mask = (*k)->GetDestNetworkMask();
-            Ipv4Address entry = (*k)->GetDestNetwork();
-            if (mask.IsMatch(dest, entry))
-            {
-                NS_LOG_LOGIC("Found external route" << *k);
-                if (oif)
-                {
-                    if (oif != m_ipv4->GetNetDevice((*k)->GetInterface()))
-                    {
-                        NS_LOG_LOGIC("Not on requested interface, skipping");
-                        continue;
-                    }
-                }
-                allRoutes.push_back(*k);
-                break;
-            }
+            NS_LOG_LOGIC("Found external route" << allRoutes.front().second);
+            allRoutes.resize(1);
         }
     }
     if (!allRoutes.empty()) // if route(s) is found
@@ -215,7 +247,7 @@ Ipv4GlobalRouting::LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif)
         {
             selectIndex = 0;
         }
-        Ipv4RoutingTableEntry* route = allRoutes.at(selectIndex);
+        Ipv4RoutingTableEntry* route = allRoutes.at(selectIndex).second;
         // create a Ipv4Route object from the selected routing table entry
         rtentry = Create<Ipv4Route>();
         rtentry->SetDestination(route->GetDest());
@@ -291,6 +323,7 @@ void
 Ipv4GlobalRouting::RemoveRoute(uint32_t index)
 {
     NS_LOG_FUNCTION(this << index);
+    m_indexValid = false;
     if (index < m_hostRoutes.size())
     {
         uint32_t tmp = 0;
@@ -366,6 +399,10 @@ Ipv4GlobalRouting::DoDispose()
     {
         delete (*l);
     }
+    m_hostIndex.m_masks.clear();
+    m_networkIndex.m_masks.clear();
+    m_ASexternalIndex.m_masks.clear();
+    m_indexValid = false;
 
     Ipv4RoutingProtocol::DoDispose();
 }
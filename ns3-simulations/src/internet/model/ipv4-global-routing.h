@@ -29,6 +29,9 @@
 
 #include <list>
 #include <stdint.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace ns3
 {
@@ -276,10 +279,55 @@ class Ipv4GlobalRouting : public Ipv4RoutingProtocol
      */
     Ptr<Ipv4Route> LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif = nullptr);
 
+    /**
+     * \brief Index of the routes of a table by destination.
+     *
+     * The routes are grouped by mask, then by masked destination, so that
+     * a lookup costs a hash lookup per distinct mask of the table instead
+     * of a test per route. Each route keeps its position in the table, and
+     * the lookups return the matching routes in the table order.
+     */
+    struct RouteIndex
+    {
+        /// A route and its position in the table
+        typedef std::pair<uint32_t, Ipv4RoutingTableEntry*> Entry;
+        /// Routes sharing a mask, by masked destination
+        typedef std::unordered_map<uint32_t, std::vector<Entry>> Routes;
+
+        /**
+         * \brief Index the routes of a table.
+         * \param [in] routes the routes of the table
+         * \param [in] host whether the routes are host routes
+         */
+        void Build(const std::list<Ipv4RoutingTableEntry*>& routes, bool host);
+
+        /**
+         * \brief Append the routes matching a destination.
+         * \param [in] dest the destination address
+         * \param [in,out] matches the matching routes, in the table order
+         */
+        void Lookup(Ipv4Address dest, std::vector<Entry>& matches) const;
+
+        std::vector<std::pair<uint32_t, Routes>> m_masks; //!< Routes of each mask
+    };
+
+    /**
+     * \brief Drop the routes which are not on an output interface.
+     * \param [in,out] matches the routes
+     * \param [in] oif the output interface, if any
+     */
+    void FilterInterface(std::vector<RouteIndex::Entry>& matches, Ptr<NetDevice> oif) const;
+
     HostRoutes m_hostRoutes;             //!< Routes to hosts
     NetworkRoutes m_networkRoutes;       //!< Routes to networks
     ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+    bool m_indexValid;                        //!< Whether the indexes match the routes
+    RouteIndex m_hostIndex;                   //!< Index of the routes to hosts
+    RouteIndex m_networkIndex;                //!< Index of the routes to networks
+    RouteIndex m_ASexternalIndex;             //!< Index of the external routes
+    std::vector<RouteIndex::Entry> m_matches; //!< Routes matching the current lookup
+
     Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
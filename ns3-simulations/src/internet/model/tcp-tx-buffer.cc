@@ -169,7 +169,9 @@ TcpTxBuffer::SetHeadSequence(const SequenceNumber32& seq)
 
     if (!m_sentList.empty())
     {
+        UnindexItem(m_sentList.front());
         m_sentList.front()->m_startSeq = seq;
+        IndexItem(m_sentList.begin());
     }
 
     // if you change the head with data already sent, something bad will happen
@@ -295,7 +297,7 @@ TcpTxBuffer::GetNewSegment(uint32_t numBytes)
     NS_ASSERT(it != m_appList.end());
 
     m_appList.erase(it);
-    m_sentList.insert(m_sentList.end(), item);
+    IndexItem(m_sentList.insert(m_sentList.end(), item));
     m_sentSize += item->m_packet->GetSize();
 
     return item;
@@ -309,15 +311,15 @@ TcpTxBuffer::GetTransmittedSegment(uint32_t numBytes, const SequenceNumber32& se
     NS_ASSERT(numBytes <= m_sentSize);
     NS_ASSERT(!m_sentList.empty());
 
-    auto it = m_sentList.begin();
     bool listEdited = false;
     uint32_t s = numBytes;
 
     // Avoid to merge different packet for this retransmission if flags are
     // different.
-    for (; it != m_sentList.end(); ++it)
+    auto sent = m_sentIndex.find(seq);
+    if (sent != m_sentIndex.end())
     {
-        if ((*it)->m_startSeq == seq)
+        auto it = sent->second;
         {
             auto next = it;
             next++;
@@ -339,7 +341,6 @@ TcpTxBuffer::GetTransmittedSegment(uint32_t numBytes, const SequenceNumber32& se
             {
                 s = std::min(s, (*it)->m_packet->GetSize());
             }
-            break;
         }
     }
 
@@ -347,8 +348,11 @@ TcpTxBuffer::GetTransmittedSegment(uint32_t numBytes, const SequenceNumber32& se
 
     if (!item->m_retrans)
     {
+        auto it = m_sentIndex.at(item->m_startSeq);
+        UnindexItem(item);
         m_retrans += item->m_packet->GetSize();
         item->m_retrans = true;
+        IndexItem(it);
     }
 
     return item;
@@ -438,6 +442,20 @@ TcpTxBuffer::GetPacketFromList(PacketList& list,
     auto it = list.begin();
     SequenceNumber32 beginOfCurrentPacket = listStartFrom;
 
+    // the items of the sent list are indexed: start from the one which
+    // contains seq, and keep the index up to date when editing the list
+    auto self = const_cast<TcpTxBuffer*>(this);
+    bool isSentList = &list == &m_sentList;
+    if (isSentList)
+    {
+        auto found = FindSentItem(seq);
+        if (found != list.end())
+        {
+            it = found;
+            beginOfCurrentPacket = (*it)->m_startSeq;
+        }
+    }
+
     while (it != list.end())
     {
         currentItem = *it;
@@ -468,10 +486,19 @@ TcpTxBuffer::GetPacketFromList(PacketList& list,
                                          << " and now we recurse because packet ends at "
                                          << beginOfCurrentPacket + currentPacket->GetSize());
                 auto firstPart = new TcpTxItem();
+                if (isSentList)
+                {
+                    self->UnindexItem(currentItem);
+                }
                 SplitItems(firstPart, currentItem, seq - beginOfCurrentPacket);
 
                 // insert firstPart before currentItem
-                list.insert(it, firstPart);
+                auto first = list.insert(it, firstPart);
+                if (isSentList)
+                {
+                    self->IndexItem(first);
+                    self->IndexItem(it);
+                }
                 if (listEdited)
                 {
                     *listEdited = true;
@@ -534,10 +561,19 @@ TcpTxBuffer::GetPacketFromList(PacketList& list,
                 // the end is inside the current packet, but it isn't exactly
                 // the packet end. Just fragment, fix the list, and return.
                 auto firstPart = new TcpTxItem();
+                if (isSentList)
+                {
+                    self->UnindexItem(currentItem);
+                }
                 SplitItems(firstPart, currentItem, numBytes);
 
                 // insert firstPart before currentItem
-                list.insert(it, firstPart);
+                auto first = list.insert(it, firstPart);
+                if (isSentList)
+                {
+                    self->IndexItem(first);
+                    self->IndexItem(it);
+                }
                 if (listEdited)
                 {
                     *listEdited = true;
@@ -565,8 +601,17 @@ TcpTxBuffer::GetPacketFromList(PacketList& list,
             TcpTxItem* next = (*it); // Please remember we have incremented it
                                      // in the previous if
 
+            if (isSentList)
+            {
+                self->UnindexItem(currentItem);
+                self->UnindexItem(next);
+            }
             MergeItems(currentItem, next);
-            list.erase(it);
+            it = list.erase(it);
+            if (isSentList)
+            {
+                self->IndexItem(std::prev(it));
+            }
 
             delete next;
 
@@ -624,6 +669,81 @@ TcpTxBuffer::MergeItems(TcpTxItem* t1, TcpTxItem* t2) const
     NS_LOG_INFO("Situation after the merge: " << *t1);
 }
 
+void
+TcpTxBuffer::IndexItem(PacketList::iterator it)
+{
+    const TcpTxItem* item = *it;
+    const SequenceNumber32& seq = item->m_startSeq;
+    m_sentIndex.emplace(seq, it);
+    if (item->m_lost)
+    {
+        m_lostIndex.emplace(seq, it);
+    }
+    if (item->m_sacked)
+    {
+        m_sackedIndex.emplace(seq, it);
+        return;
+    }
+    m_unsackedIndex.emplace(seq, it);
+    if (item->m_lost)
+    {
+        if (!item->m_retrans)
+        {
+            m_toRetransIndex.emplace(seq, it);
+        }
+    }
+    else
+    {
+        m_inFlightIndex.emplace(seq, it);
+        if (!item->m_retrans)
+        {
+            m_rescueIndex.emplace(seq, it);
+        }
+    }
+}
+
+void
+TcpTxBuffer::UnindexItem(const TcpTxItem* item)
+{
+    const SequenceNumber32& seq = item->m_startSeq;
+    m_sentIndex.erase(seq);
+    m_sackedIndex.erase(seq);
+    m_lostIndex.erase(seq);
+    m_unsackedIndex.erase(seq);
+    m_inFlightIndex.erase(seq);
+    m_toRetransIndex.erase(seq);
+    m_rescueIndex.erase(seq);
+}
+
+void
+TcpTxBuffer::ClearIndexes()
+{
+    m_sentIndex.clear();
+    m_sackedIndex.clear();
+    m_lostIndex.clear();
+    m_unsackedIndex.clear();
+    m_inFlightIndex.clear();
+    m_toRetransIndex.clear();
+    m_rescueIndex.clear();
+}
+
+TcpTxBuffer::PacketList::iterator
+TcpTxBuffer::FindSentItem(const SequenceNumber32& seq) const
+{
+    auto self = const_cast<TcpTxBuffer*>(this);
+    auto next = m_sentIndex.upper_bound(seq);
+    if (next == m_sentIndex.begin())
+    {
+        return self->m_sentList.end();
+    }
+    PacketList::iterator it = (--next)->second;
+    if (seq >= (*it)->m_startSeq + (*it)->m_packet->GetSize())
+    {
+        return self->m_sentList.end();
+    }
+    return it;
+}
+
 void
 TcpTxBuffer::RemoveFromCounts(TcpTxItem* item, uint32_t size)
 {
@@ -650,16 +770,15 @@ bool
 TcpTxBuffer::IsRetransmittedDataAcked(const SequenceNumber32& ack) const
 {
     NS_LOG_FUNCTION(this);
-    for (const auto& it : m_sentList)
+    // the only item which can end at ack is the one before ack
+    auto next = m_sentIndex.lower_bound(ack);
+    if (next == m_sentIndex.begin())
     {
-        TcpTxItem* item = it;
-        Ptr<Packet> p = item->m_packet;
-        if (item->m_startSeq + p->GetSize() == ack && !item->m_sacked && item->m_retrans)
-        {
-            return true;
-        }
+        return false;
     }
-    return false;
+    TcpTxItem* item = *(--next)->second;
+    Ptr<Packet> p = item->m_packet;
+    return item->m_startSeq + p->GetSize() == ack && !item->m_sacked && item->m_retrans;
 }
 
 void
@@ -708,6 +827,7 @@ TcpTxBuffer::DiscardUpTo(const SequenceNumber32& seq, const Callback<void, TcpTx
 
             RemoveFromCounts(item, pktSize);
 
+            UnindexItem(item);
             i = m_sentList.erase(i);
             NS_LOG_INFO("Removed " << *item << " lost: " << m_lostOut << " retrans: " << m_retrans
                                    << " sacked: " << m_sackedOut << ". Remaining data " << m_size);
@@ -725,8 +845,10 @@ TcpTxBuffer::DiscardUpTo(const SequenceNumber32& seq, const Callback<void, TcpTx
             pktSize -= offset;
             NS_LOG_INFO(*item);
             // PacketTags are preserved when fragmenting
+            UnindexItem(item);
             item->m_packet = item->m_packet->CreateFragment(offset, pktSize);
             item->m_startSeq += offset;
+            IndexItem(i);
             m_size -= offset;
             m_sentSize -= offset;
             m_firstByteSeq += offset;
@@ -754,8 +876,10 @@ TcpTxBuffer::DiscardUpTo(const SequenceNumber32& seq, const Callback<void, TcpTx
             // It is not possible to have the UNA sacked; otherwise, it would
             // have been ACKed. This is, most likely, our wrong guessing
             // when adding Reno dupacks in the count.
+            UnindexItem(head);
             head->m_sacked = false;
             m_sackedOut -= head->m_packet->GetSize();
+            IndexItem(m_sentList.begin());
             NS_LOG_INFO("Moving the SACK flag from the HEAD to another segment");
             AddRenoSack();
             MarkHeadAsLost();
@@ -789,64 +913,25 @@ TcpTxBuffer::Update(const TcpOptionSack::SackList& list, const Callback<void, Tc
 
     for (auto option_it = list.begin(); option_it != list.end(); ++option_it)
     {
-        auto item_it = m_sentList.begin();
-        SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
         if (m_firstByteSeq + m_sentSize < (*option_it).first)
         {
             NS_LOG_INFO("Not updating scoreboard, the option block is outside the sent list");
             return bytesSacked;
         }
 
-        while (item_it != m_sentList.end())
+        // Only mark as sacked the packets precisely mapped over the option. It
+        // means that if the receiver is reporting as sacked single range bytes
+        // that are not mapped 1:1 in what we have, the option is discarded.
+        // There's room for improvement here. The packets already sacked are
+        // not in the index, and are skipped.
+        auto index_it = m_unsackedIndex.lower_bound((*option_it).first);
+        while (index_it != m_unsackedIndex.end())
         {
+            auto item_it = index_it->second;
+            SequenceNumber32 beginOfCurrentPacket = (*item_it)->m_startSeq;
             uint32_t pktSize = (*item_it)->m_packet->GetSize();
 
-            // Check the boundary of this packet ... only mark as sacked if
-            // it is precisely mapped over the option. It means that if the receiver
-            // is reporting as sacked single range bytes that are not mapped 1:1
-            // in what we have, the option is discarded. There's room for improvement
-            // here.
-            if (beginOfCurrentPacket >= (*option_it).first &&
-                beginOfCurrentPacket + pktSize <= (*option_it).second)
-            {
-                if ((*item_it)->m_sacked)
-                {
-                    NS_ASSERT(!(*item_it)->m_lost);
-                    NS_LOG_INFO("Received block " << *option_it << ", checking sentList for block "
-                                                  << *(*item_it)
-                                                  << ", found in the sackboard already sacked");
-                }
-                else
-                {
-                    if ((*item_it)->m_lost)
-                    {
-                        (*item_it)->m_lost = false;
-                        m_lostOut -= (*item_it)->m_packet->GetSize();
-                    }
-
-                    (*item_it)->m_sacked = true;
-                    m_sackedOut += (*item_it)->m_packet->GetSize();
-                    bytesSacked += (*item_it)->m_packet->GetSize();
-
-                    if (m_highestSack.first == m_sentList.end() ||
-                        m_highestSack.second <= beginOfCurrentPacket + pktSize)
-                    {
-                        m_highestSack = std::make_pair(item_it, beginOfCurrentPacket);
-                    }
-
-                    NS_LOG_INFO("Received block "
-                                << *option_it << ", checking sentList for block " << *(*item_it)
-                                << ", found in the sackboard, sacking, current highSack: "
-                                << m_highestSack.second);
-
-                    if (!sackedCb.IsNull())
-                    {
-                        sackedCb(*item_it);
-                    }
-                }
-            }
-            else if (beginOfCurrentPacket + pktSize > (*option_it).second)
+            if (beginOfCurrentPacket + pktSize > (*option_it).second)
             {
                 // We already passed the received block end. Exit from the loop
                 NS_LOG_INFO("Received block [" << *option_it << ", checking sentList for block "
@@ -854,8 +939,35 @@ TcpTxBuffer::Update(const TcpOptionSack::SackList& list, const Callback<void, Tc
                 break;
             }
 
-            beginOfCurrentPacket += pktSize;
-            ++item_it;
+            // the item leaves the index when sacked
+            ++index_it;
+            UnindexItem(*item_it);
+            if ((*item_it)->m_lost)
+            {
+                (*item_it)->m_lost = false;
+                m_lostOut -= (*item_it)->m_packet->GetSize();
+            }
+
+            (*item_it)->m_sacked = true;
+            m_sackedOut += (*item_it)->m_packet->GetSize();
+            bytesSacked += (*item_it)->m_packet->GetSize();
+            IndexItem(item_it);
+
+            if (m_highestSack.first == m_sentList.end() ||
+                m_highestSack.second <= beginOfCurrentPacket + pktSize)
+            {
+                m_highestSack = std::make_pair(item_it, beginOfCurrentPacket);
+            }
+
+            NS_LOG_INFO("Received block " << *option_it << ", checking sentList for block "
+                                          << *(*item_it)
+                                          << ", found in the sackboard, sacking, current highSack: "
+                                          << m_highestSack.second);
+
+            if (!sackedCb.IsNull())
+            {
+                sackedCb(*item_it);
+            }
         }
     }
 
@@ -878,45 +990,58 @@ void
 TcpTxBuffer::UpdateLostCount()
 {
     NS_LOG_FUNCTION(this);
-    uint32_t sacked = 0;
-    SequenceNumber32 beginOfCurrentPacket = m_highestSack.second;
     if (m_highestSack.first == m_sentList.end())
     {
-        NS_LOG_INFO("Status before the update: " << *this
-                                                 << ", will start from the latest sent item");
+        NS_LOG_INFO("Status before the update: " << *this << ", no item is sacked");
+        return;
     }
-    else
+    NS_LOG_INFO("Status before the update: " << *this << ", will start from item "
+                                             << *(*m_highestSack.first));
+
+    // Counting the sacked items down from the highest sacked one, the head
+    // excluded, the items below the m_dupAckThresh-th one are lost, and so
+    // is the head: find that item in the index of the sacked items
+    SequenceNumber32 headSeq = m_sentList.front()->m_startSeq;
+    SequenceNumber32 highestSeq = (*m_highestSack.first)->m_startSeq;
+    bool found = false;
+    SequenceNumber32 limit;
+    if (m_dupAckThresh == 0)
     {
-        NS_LOG_INFO("Status before the update: " << *this << ", will start from item "
-                                                 << *(*m_highestSack.first));
+        found = true;
+        limit = highestSeq + 1;
     }
-
-    for (auto it = m_highestSack.first; it != m_sentList.begin(); --it)
+    else
     {
-        TcpTxItem* item = *it;
-        if (item->m_sacked)
-        {
-            sacked++;
-        }
-
-        if (sacked >= m_dupAckThresh)
+        uint32_t sacked = 0;
+        for (auto it = m_sackedIndex.upper_bound(highestSeq); it != m_sackedIndex.begin();)
         {
-            if (!item->m_sacked && !item->m_lost)
+            --it;
+            if (it->first <= headSeq)
             {
-                item->m_lost = true;
-                m_lostOut += item->m_packet->GetSize();
+                break;
+            }
+            if (++sacked == m_dupAckThresh)
+            {
+                found = true;
+                limit = it->first;
+                break;
             }
         }
-        beginOfCurrentPacket -= item->m_packet->GetSize();
     }
 
-    if (sacked >= m_dupAckThresh)
+    // then mark the items below it which are neither sacked nor lost
+    if (found)
     {
-        TcpTxItem* item = *m_sentList.begin();
-        if (!item->m_lost)
+        auto index_it = m_inFlightIndex.begin();
+        while (index_it != m_inFlightIndex.end() && index_it->first < limit)
         {
-            item->m_lost = true;
-            m_lostOut += item->m_packet->GetSize();
+            auto item_it = index_it->second;
+            // the item leaves the index when marked
+            ++index_it;
+            UnindexItem(*item_it);
+            (*item_it)->m_lost = true;
+            m_lostOut += (*item_it)->m_packet->GetSize();
+            IndexItem(item_it);
         }
     }
     NS_LOG_INFO("Status after the update: " << *this);
@@ -928,34 +1053,22 @@ TcpTxBuffer::IsLost(const SequenceNumber32& seq) const
 {
     NS_LOG_FUNCTION(this << seq);
 
-    SequenceNumber32 beginOfCurrentPacket = m_firstByteSeq;
-
     if (seq >= m_highestSack.second)
     {
         return false;
     }
 
-    // In theory, using a map and hints when inserting elements can improve
-    // performance
-    for (auto it = m_sentList.begin(); it != m_sentList.end(); ++it)
+    // The first item from seq on which is lost or sacked decides
+    auto lost = m_lostIndex.lower_bound(seq);
+    auto sacked = m_sackedIndex.lower_bound(seq);
+    if (lost != m_lostIndex.end() && (sacked == m_sackedIndex.end() || lost->first <= sacked->first))
     {
-        // Search for the right iterator before calling IsLost()
-        if (beginOfCurrentPacket >= seq)
-        {
-            if ((*it)->m_lost)
-            {
-                NS_LOG_INFO("seq=" << seq << " is lost because of lost flag");
-                return true;
-            }
-
-            if ((*it)->m_sacked)
-            {
-                NS_LOG_INFO("seq=" << seq << " is not lost because of sacked flag");
-                return false;
-            }
-        }
-
-        beginOfCurrentPacket += (*it)->m_packet->GetSize();
+        NS_LOG_INFO("seq=" << seq << " is lost because of lost flag");
+        return true;
+    }
+    if (sacked != m_sackedIndex.end())
+    {
+        NS_LOG_INFO("seq=" << seq << " is not lost because of sacked flag");
     }
 
     return false;
@@ -979,35 +1092,29 @@ TcpTxBuffer::NextSeg(SequenceNumber32* seq, SequenceNumber32* seqHigh, bool isRe
      *
      *     (1.c) IsLost (S2) returns true.
      */
-    TcpTxItem* item;
+    // Condition 1.a , 1.b , and 1.c
+    if (!m_toRetransIndex.empty())
+    {
+        NS_LOG_INFO("IsLost, returning" << m_toRetransIndex.begin()->first);
+        *seq = m_toRetransIndex.begin()->first;
+        *seqHigh = *seq + m_segmentSize;
+        return true;
+    }
+
+    // The first item neither retransmitted, sacked nor lost; a sequence
+    // number of value 0 stands for none, and is replaced by the next one
     SequenceNumber32 seqPerRule3;
     bool isSeqPerRule3Valid = false;
-    SequenceNumber32 beginOfCurrentPkt = m_firstByteSeq;
-
-    for (auto it = m_sentList.begin(); it != m_sentList.end(); ++it)
+    if (isRecovery && !m_rescueIndex.empty())
     {
-        item = *it;
-
-        // Condition 1.a , 1.b , and 1.c
-        if (!item->m_retrans && !item->m_sacked)
+        auto it = m_rescueIndex.begin();
+        isSeqPerRule3Valid = true;
+        seqPerRule3 = it->first;
+        if (seqPerRule3.GetValue() == 0 && ++it != m_rescueIndex.end())
         {
-            if (item->m_lost)
-            {
-                NS_LOG_INFO("IsLost, returning" << beginOfCurrentPkt);
-                *seq = beginOfCurrentPkt;
-                *seqHigh = *seq + m_segmentSize;
-                return true;
-            }
-            else if (seqPerRule3.GetValue() == 0 && isRecovery)
-            {
-                NS_LOG_INFO("Saving for rule 3 the seq " << beginOfCurrentPkt);
-                isSeqPerRule3Valid = true;
-                seqPerRule3 = beginOfCurrentPkt;
-            }
+            seqPerRule3 = it->first;
         }
-
-        // Nothing found, iterate
-        beginOfCurrentPkt += item->m_packet->GetSize();
+        NS_LOG_INFO("Saving for rule 3 the seq " << seqPerRule3);
     }
 
     /* (2) If no sequence number 'S2' per rule (1) exists but there
@@ -1218,9 +1325,12 @@ TcpTxBuffer::ResetRenoSack()
     NS_LOG_FUNCTION(this);
 
     m_sackedOut = 0;
-    for (auto it = m_sentList.begin(); it != m_sentList.end(); ++it)
+    while (!m_sackedIndex.empty())
     {
+        auto it = m_sackedIndex.begin()->second;
+        UnindexItem(*it);
         (*it)->m_sacked = false;
+        IndexItem(it);
     }
 
     m_highestSack = std::make_pair(m_sentList.end(), SequenceNumber32(0));
@@ -1247,6 +1357,7 @@ TcpTxBuffer::ResetSentList()
         m_appList.push_front(item);
         m_sentList.pop_back();
     }
+    ClearIndexes();
 
     m_sentSize = 0;
     m_lostOut = 0;
@@ -1263,6 +1374,7 @@ TcpTxBuffer::ResetLastSegmentSent()
     {
         TcpTxItem* item = m_sentList.back();
 
+        UnindexItem(item);
         m_sentList.pop_back();
         m_sentSize -= item->m_packet->GetSize();
         if (item->m_retrans)
@@ -1291,6 +1403,7 @@ TcpTxBuffer::SetSentListLost(bool resetSack)
         m_lostOut = 0;
     }
 
+    ClearIndexes();
     for (auto it = m_sentList.begin(); it != m_sentList.end(); ++it)
     {
         if (resetSack)
@@ -1314,6 +1427,7 @@ TcpTxBuffer::SetSentListLost(bool resetSack)
         }
 
         (*it)->m_retrans = false;
+        IndexItem(it);
     }
 
     NS_LOG_INFO("Set sent list lost, status: " << *this);
@@ -1346,8 +1460,10 @@ TcpTxBuffer::DeleteRetransmittedFlagFromHead()
 
     if (m_sentList.front()->m_retrans)
     {
+        UnindexItem(m_sentList.front());
         m_sentList.front()->m_retrans = false;
         m_retrans -= m_sentList.front()->m_packet->GetSize();
+        IndexItem(m_sentList.begin());
     }
     ConsistencyCheck();
 }
@@ -1357,6 +1473,8 @@ TcpTxBuffer::MarkHeadAsLost()
 {
     if (!m_sentList.empty())
     {
+        UnindexItem(m_sentList.front());
+
         // If the head is sacked (reneging by the receiver the previously sent
         // information) we revert the sacked flag.
         // A sacked head means that we should advance SND.UNA.. so it's an error.
@@ -1377,6 +1495,8 @@ TcpTxBuffer::MarkHeadAsLost()
             m_sentList.front()->m_lost = true;
             m_lostOut += m_sentList.front()->m_packet->GetSize();
         }
+
+        IndexItem(m_sentList.begin());
     }
     ConsistencyCheck();
 }
@@ -1397,20 +1517,18 @@ TcpTxBuffer::AddRenoSack()
 
     m_renoSack = true;
 
-    // We can _never_ SACK the head, so start from the second segment sent
-    auto it = ++m_sentList.begin();
-
-    // Find the "highest sacked" point, that is SND.UNA + m_sackedOut
-    while (it != m_sentList.end() && (*it)->m_sacked)
-    {
-        ++it;
-    }
+    // We can _never_ SACK the head, so start from the second segment sent,
+    // and find the "highest sacked" point, that is SND.UNA + m_sackedOut
+    auto next = m_unsackedIndex.upper_bound(m_sentList.front()->m_startSeq);
 
     // Add to the sacked size the size of the first "not sacked" segment
-    if (it != m_sentList.end())
+    if (next != m_unsackedIndex.end())
     {
+        auto it = next->second;
+        UnindexItem(*it);
         (*it)->m_sacked = true;
         m_sackedOut += (*it)->m_packet->GetSize();
+        IndexItem(it);
         m_highestSack = std::make_pair(it, (*it)->m_startSeq);
         NS_LOG_INFO("Added a Reno SACK, status: " << *this);
     }
@@ -28,6 +28,9 @@
 #include "ns3/sequence-number.h"
 #include "ns3/traced-value.h"
 
+#include <list>
+#include <map>
+
 namespace ns3
 {
 class Packet;
@@ -74,6 +77,15 @@ class Packet;
  * documentation) and maintaining the scoreboard is a matter of travelling the
  * list and set the SACK flag on the corresponding segment sent.
  *
+ * To avoid travelling the whole list on every ACK, the sent items are also
+ * indexed by their first sequence number, both all together and by state
+ * (sacked, lost, neither, lost and not retransmitted, ...). The SACK
+ * blocks only visit the items which are not sacked yet, the lost count
+ * only visits the items which become lost, and IsLost, NextSeg and
+ * GetTransmittedSegment look up their item in logarithmic time. Every
+ * change of the flags, or of the first sequence number, of a sent item
+ * goes through UnindexItem and IndexItem.
+ *
  * Item properties
  * ---------------
  *
@@ -419,6 +431,37 @@ class TcpTxBuffer : public Object
 
     typedef std::list<TcpTxItem*> PacketList; //!< container for data stored in the buffer
 
+    /// Index of sent items, by their first sequence number
+    typedef std::map<SequenceNumber32, PacketList::iterator> SentIndex;
+
+    /**
+     * \brief Add a sent item to the indexes matching its flags
+     * \param it the item, in the sent list
+     */
+    void IndexItem(PacketList::iterator it);
+
+    /**
+     * \brief Remove a sent item from the indexes
+     *
+     * Called before changing the flags, or the first sequence number, of
+     * the item, or before removing it from the sent list.
+     *
+     * \param item the item
+     */
+    void UnindexItem(const TcpTxItem* item);
+
+    /**
+     * \brief Remove all the sent items from the indexes
+     */
+    void ClearIndexes();
+
+    /**
+     * \brief Find the sent item which contains a sequence number
+     * \param seq the sequence number
+     * \return the item, or the end of the sent list if no item contains seq
+     */
+    PacketList::iterator FindSentItem(const SequenceNumber32& seq) const;
+
     /**
      * \brief Update the lost count
      *
@@ -435,8 +478,8 @@ class TcpTxBuffer : public Object
      * The {New}Reno cases, for now, are managed in TcpSocketBase through the
      * call to MarkHeadAsLost.
      * This function is, therefore, called after a SACK option has been received,
-     * and updates the lost count. It can be probably optimized by not walking
-     * the entire list, but a subset.
+     * and updates the lost count. It only walks the last dupAckThresh sacked
+     * items and the items which become lost.
      *
      */
     void UpdateLostCount();
@@ -624,6 +667,14 @@ class TcpTxBuffer : public Object
         m_firstByteSeq; //!< Sequence number of the first byte in data (SND.UNA)
     std::pair<PacketList::const_iterator, SequenceNumber32> m_highestSack; //!< Highest SACK byte
 
+    SentIndex m_sentIndex;      //!< All the sent items
+    SentIndex m_sackedIndex;    //!< The sacked items
+    SentIndex m_lostIndex;      //!< The lost items
+    SentIndex m_unsackedIndex;  //!< The items not sacked
+    SentIndex m_inFlightIndex;  //!< The items neither sacked nor lost
+    SentIndex m_toRetransIndex; //!< The lost items neither sacked nor retransmitted
+    SentIndex m_rescueIndex;    //!< The items neither sacked, lost nor retransmitted
+
     uint32_t m_lostOut{0};   //!< Number of lost bytes
     uint32_t m_sackedOut{0}; //!< Number of sacked bytes
     uint32_t m_retrans{0};   //!< Number of retransmitted bytes
@@ -0,0 +1,167 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-interface-address.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/loopback-net-device.h"
+#include "ns3/node.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief Check that the indexed lookups of the IPv4 endpoint demux find
+ * the most exact match, also when the endpoints change after allocation.
+ */
+class Ipv4EndPointDemuxLookupTestCase : public TestCase
+{
+  public:
+    Ipv4EndPointDemuxLookupTestCase();
+    void DoRun() override;
+
+  private:
+    /**
+     * \brief Look up the endpoint of a packet.
+     * \param daddr destination address
+     * \param dport destination port
+     * \param saddr source address
+     * \param sport source port
+     * \return the endpoint, or nullptr if none
+     */
+    Ipv4EndPoint* Lookup(Ipv4Address daddr, uint16_t dport, Ipv4Address saddr, uint16_t sport);
+
+    Ipv4EndPointDemux m_demux;      //!< the demux
+    Ptr<Ipv4Interface> m_interface; //!< the incoming interface
+};
+
+Ipv4EndPointDemuxLookupTestCase::Ipv4EndPointDemuxLookupTestCase()
+    : TestCase("Check the lookups of the IPv4 endpoint demux")
+{
+}
+
+Ipv4EndPoint*
+Ipv4EndPointDemuxLookupTestCase::Lookup(Ipv4Address daddr,
+                                        uint16_t dport,
+                                        Ipv4Address saddr,
+                                        uint16_t sport)
+{
+    Ipv4EndPointDemux::EndPoints endPoints =
+        m_demux.Lookup(daddr, dport, saddr, sport, m_interface);
+    return endPoints.empty() ? nullptr : endPoints.front();
+}
+
+void
+Ipv4EndPointDemuxLookupTestCase::DoRun()
+{
+    Ptr<Node> node = CreateObject<Node>();
+    Ptr<LoopbackNetDevice> device = CreateObject<LoopbackNetDevice>();
+    node->AddDevice(device);
+    m_interface = CreateObject<Ipv4Interface>();
+    m_interface->SetDevice(device);
+    m_interface->SetNode(node);
+    m_interface->AddAddress(Ipv4InterfaceAddress("10.1.1.1", "255.255.255.0"));
+
+    Ipv4Address local("10.1.1.1");
+    Ipv4Address peer("10.1.2.2");
+    Ipv4Address other("10.1.2.3");
+
+    // the listeners, and the connections accepted from them
+    Ipv4EndPoint* any = m_demux.Allocate(nullptr, 80);
+    Ipv4EndPoint* bound = m_demux.Allocate(nullptr, local, 80);
+    std::vector<Ipv4EndPoint*> connections;
+    for (uint16_t port = 1000; port < 2000; port++)
+    {
+        connections.push_back(m_demux.Allocate(nullptr, local, 80, peer, port));
+    }
+    NS_TEST_EXPECT_MSG_EQ(m_demux.Allocate(nullptr, local, 80, peer, 1000),
+                          nullptr,
+                          "Duplicated connection allocated");
+    NS_TEST_EXPECT_MSG_EQ(m_demux.Allocate(nullptr, local, 80), nullptr, "Duplicated listener");
+    NS_TEST_EXPECT_MSG_EQ(m_demux.LookupPortLocal(80), true, "Port 80 not found");
+    NS_TEST_EXPECT_MSG_EQ(m_demux.LookupPortLocal(81), false, "Port 81 found");
+
+    bool found = true;
+    for (uint16_t port = 1000; port < 2000; port++)
+    {
+        found &= Lookup(local, 80, peer, port) == connections[port - 1000];
+    }
+    NS_TEST_EXPECT_MSG_EQ(found, true, "Connection not found");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, 80, peer, 2000), bound, "Bound listener not found");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, 80, other, 1000), bound, "Bound listener not found");
+    NS_TEST_EXPECT_MSG_EQ(Lookup("10.1.1.9", 80, peer, 1000), any, "Any listener not found");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, 81, peer, 1000), nullptr, "Endpoint on port 81 found");
+    NS_TEST_EXPECT_MSG_EQ(m_demux.SimpleLookup(local, 80, peer, 1500),
+                          connections[500],
+                          "Simple lookup of a connection failed");
+
+    // an endpoint connected after allocation is indexed again
+    Ipv4EndPoint* client = m_demux.Allocate(local);
+    NS_TEST_ASSERT_MSG_NE(client, nullptr, "Ephemeral port allocation failed");
+    uint16_t ephemeral = client->GetLocalPort();
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, ephemeral, peer, 80), client, "Client not found");
+    client->SetPeer(peer, 80);
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, ephemeral, peer, 80), client, "Client not found");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, ephemeral, other, 80), nullptr, "Connected client found");
+    client->SetPeer(other, 80);
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, ephemeral, peer, 80), nullptr, "Old peer found");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, ephemeral, other, 80), client, "New peer not found");
+
+    // an endpoint bound to the subnet matches all but the local address,
+    // which takes precedence over a listener bound to the address
+    Ipv4EndPoint* subnet = m_demux.Allocate(nullptr, "10.1.1.0", 82, peer, 3000);
+    Ipv4EndPoint* listener = m_demux.Allocate(nullptr, local, 82);
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, 82, peer, 3000), subnet, "Subnet endpoint not found");
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, 82, peer, 3001), listener, "Listener not found");
+
+    // the lookups fall back to the listeners once the connections are gone
+    for (auto connection : connections)
+    {
+        m_demux.DeAllocate(connection);
+    }
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, 80, peer, 1000), bound, "Bound listener not found");
+    m_demux.DeAllocate(bound);
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, 80, peer, 1000), any, "Any listener not found");
+    m_demux.DeAllocate(any);
+    NS_TEST_EXPECT_MSG_EQ(Lookup(local, 80, peer, 1000), nullptr, "Endpoint found");
+    NS_TEST_EXPECT_MSG_EQ(m_demux.LookupPortLocal(80), false, "Port 80 found");
+
+    m_interface = nullptr;
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief IPv4 endpoint demux TestSuite
+ */
+class Ipv4EndPointDemuxTestSuite : public TestSuite
+{
+  public:
+    Ipv4EndPointDemuxTestSuite()
+        : TestSuite("ipv4-end-point-demux", UNIT)
+    {
+        AddTestCase(new Ipv4EndPointDemuxLookupTestCase(), TestCase::QUICK);
+    }
+};
+
+static Ipv4EndPointDemuxTestSuite
+    g_ipv4EndPointDemuxTestSuite; //!< Static variable for test initialization
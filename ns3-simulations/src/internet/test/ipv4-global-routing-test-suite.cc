@@ -23,12 +23,15 @@
 #include "ns3/ipv4-global-routing.h"
 #include "ns3/ipv4-l3-protocol.h"
 #include "ns3/ipv4-packet-info-tag.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4-routing-helper.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-static-routing-helper.h"
 #include "ns3/log.h"
 #include "ns3/node-container.h"
 #include "ns3/node.h"
+#include "ns3/output-stream-wrapper.h"
 #include "ns3/packet.h"
 #include "ns3/pointer.h"
 #include "ns3/simple-channel.h"
@@ -41,6 +44,8 @@
 #include "ns3/udp-socket-factory.h"
 #include "ns3/uinteger.h"
 
+#include <sstream>
+#include <string>
 #include <vector>
 
 using namespace ns3;
@@ -1312,6 +1317,189 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup internet-test
+ *
+ * \brief IPv4 GlobalRouting lookups across overlapping routes
+ */
+class Ipv4GlobalRoutingLookupTestCase : public TestCase
+{
+  public:
+    Ipv4GlobalRoutingLookupTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Check the output device of the route to a destination.
+     * \param [in] dest the destination
+     * \param [in] oif the requested output device, if any
+     * \param [in] expected the expected output device, or null for no route
+     * \param [in] msg the check description
+     */
+    void CheckRoute(Ipv4Address dest,
+                    Ptr<NetDevice> oif,
+                    Ptr<NetDevice> expected,
+                    std::string msg);
+
+    Ptr<Ipv4GlobalRouting> m_routing; //!< Routing of the node under test
+};
+
+Ipv4GlobalRoutingLookupTestCase::Ipv4GlobalRoutingLookupTestCase()
+    : TestCase("Global routing lookups across overlapping routes")
+{
+}
+
+void
+Ipv4GlobalRoutingLookupTestCase::CheckRoute(Ipv4Address dest,
+                                            Ptr<NetDevice> oif,
+                                            Ptr<NetDevice> expected,
+                                            std::string msg)
+{
+    Ipv4Header header;
+    header.SetDestination(dest);
+    Socket::SocketErrno sockerr;
+    Ptr<Ipv4Route> route = m_routing->RouteOutput(nullptr, header, oif, sockerr);
+    NS_TEST_EXPECT_MSG_EQ((route ? route->GetOutputDevice() : nullptr), expected, msg);
+}
+
+void
+Ipv4GlobalRoutingLookupTestCase::DoRun()
+{
+    Ptr<Node> node = CreateObject<Node>();
+    InternetStackHelper internet;
+    internet.Install(node);
+
+    NetDeviceContainer devices;
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice>();
+        device->SetAddress(Mac48Address::Allocate());
+        node->AddDevice(device);
+        devices.Add(device);
+    }
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase("192.168.1.0", "255.255.255.0");
+    ipv4.Assign(devices);
+
+    Ptr<Ipv4> ip = node->GetObject<Ipv4>();
+    m_routing = Ipv4RoutingHelper::GetRouting<Ipv4GlobalRouting>(ip->GetRoutingProtocol());
+    NS_TEST_ASSERT_MSG_NE(m_routing, nullptr, "No global routing on the node");
+    uint32_t if1 = ip->GetInterfaceForDevice(devices.Get(0));
+    uint32_t if2 = ip->GetInterfaceForDevice(devices.Get(1));
+    uint32_t if3 = ip->GetInterfaceForDevice(devices.Get(2));
+
+    m_routing->AddNetworkRouteTo("10.2.0.0", "255.255.0.0", if1);
+    m_routing->AddNetworkRouteTo("10.2.3.0", "255.255.255.0", if2);
+    m_routing->AddHostRouteTo("10.2.3.4", if3);
+    m_routing->AddASExternalRouteTo("10.0.0.0", "255.0.0.0", "192.168.1.2", if1);
+    m_routing->AddASExternalRouteTo("10.0.0.0", "255.0.0.0", "192.168.1.3", if2);
+
+    CheckRoute("10.2.3.4", nullptr, devices.Get(2), "Host route not preferred");
+    CheckRoute("10.2.3.4", devices.Get(1), devices.Get(1), "Output device not honoured");
+    CheckRoute("10.2.3.5", nullptr, devices.Get(0), "First network route not selected");
+    CheckRoute("10.2.3.5", devices.Get(1), devices.Get(1), "Second network route not found");
+    CheckRoute("10.2.4.5", nullptr, devices.Get(0), "Network route not found");
+    CheckRoute("10.3.0.1", nullptr, devices.Get(0), "First external route not selected");
+    CheckRoute("10.3.0.1", devices.Get(1), devices.Get(1), "Second external route not found");
+    CheckRoute("10.3.0.1", devices.Get(2), nullptr, "Unexpected external route");
+    CheckRoute("11.0.0.1", nullptr, nullptr, "Unexpected route");
+
+    // the routes changed after a lookup are taken into account
+    m_routing->RemoveRoute(0);
+    CheckRoute("10.2.3.4", nullptr, devices.Get(0), "Removed host route still used");
+    m_routing->AddHostRouteTo("10.2.3.4", if2);
+    CheckRoute("10.2.3.4", nullptr, devices.Get(1), "Added host route not used");
+    m_routing->AddNetworkRouteTo("11.0.0.0", "255.0.0.0", if3);
+    CheckRoute("11.0.0.1", nullptr, devices.Get(2), "Added network route not used");
+
+    m_routing = nullptr;
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief IPv4 GlobalRouting tables calculated by several threads
+ */
+class Ipv4GlobalRoutingThreadsTestCase : public TestCase
+{
+  public:
+    Ipv4GlobalRoutingThreadsTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Print the routing tables of the nodes.
+     * \param [in] nodes the nodes
+     * \return the routing tables
+     */
+    std::string PrintRoutingTables(const NodeContainer& nodes);
+};
+
+Ipv4GlobalRoutingThreadsTestCase::Ipv4GlobalRoutingThreadsTestCase()
+    : TestCase("Global routing tables calculated by several threads")
+{
+}
+
+std::string
+Ipv4GlobalRoutingThreadsTestCase::PrintRoutingTables(const NodeContainer& nodes)
+{
+    std::ostringstream tables;
+    Ptr<OutputStreamWrapper> stream = Create<OutputStreamWrapper>(&tables);
+    for (uint32_t i = 0; i < nodes.GetN(); i++)
+    {
+        Ptr<Ipv4> ipv4 = nodes.Get(i)->GetObject<Ipv4>();
+        Ipv4RoutingHelper::GetRouting<Ipv4GlobalRouting>(ipv4->GetRoutingProtocol())
+            ->PrintRoutingTable(stream);
+    }
+    return tables.str();
+}
+
+// A ring of 100 routers with chords, both broadcast links between two
+// routers and stub networks on the routers with a chord.
+void
+Ipv4GlobalRoutingThreadsTestCase::DoRun()
+{
+    const uint32_t nNodes = 100;
+    NodeContainer nodes;
+    nodes.Create(nNodes);
+    InternetStackHelper internet;
+    internet.Install(nodes);
+
+    SimpleNetDeviceHelper devHelper;
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase("10.1.0.0", "255.255.255.0");
+    for (uint32_t i = 0; i < nNodes; i++)
+    {
+        ipv4.Assign(devHelper.Install(NodeContainer(nodes.Get(i), nodes.Get((i + 1) % nNodes))));
+        ipv4.NewNetwork();
+        if (i % 7 == 0)
+        {
+            ipv4.Assign(
+                devHelper.Install(NodeContainer(nodes.Get(i), nodes.Get((i + 31) % nNodes))));
+            ipv4.NewNetwork();
+            ipv4.Assign(devHelper.Install(nodes.Get(i)));
+            ipv4.NewNetwork();
+        }
+    }
+
+    Config::SetGlobal("GlobalRoutingThreads", UintegerValue(1));
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    std::string expected = PrintRoutingTables(nodes);
+
+    Config::SetGlobal("GlobalRoutingThreads", UintegerValue(3));
+    Ipv4GlobalRoutingHelper::RecomputeRoutingTables();
+    std::string actual = PrintRoutingTables(nodes);
+    Config::SetGlobal("GlobalRoutingThreads", UintegerValue(0));
+
+    NS_TEST_EXPECT_MSG_GT(expected.size(), nNodes * 1000, "Missing routes");
+    NS_TEST_EXPECT_MSG_EQ(actual, expected, "Different routes calculated by several threads");
+
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup internet-test
  *
@@ -1334,6 +1522,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite()
     AddTestCase(new TwoBridgeTest, TestCase::QUICK);
     AddTestCase(new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase(new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase(new Ipv4GlobalRoutingLookupTestCase, TestCase::QUICK);
+    AddTestCase(new Ipv4GlobalRoutingThreadsTestCase, TestCase::QUICK);
 }
 
 static Ipv4GlobalRoutingTestSuite
@@ -53,6 +53,8 @@ class TcpTxBufferTestCase : public TestCase
     /** \brief Test the logic of merging items in GetTransmittedSegment()
      * which is triggered by CopyFromSequence()*/
     void TestMergeItemsWhenGetTransmittedSegment();
+    /** \brief Test the scoreboard of a large window, sacked out of order */
+    void TestLargeWindowScoreboard();
     /**
      * \brief Callback to provide a value of receiver window
      * \returns the receiver window size
@@ -88,6 +90,7 @@ TcpTxBufferTestCase::DoRun()
      */
     Simulator::Schedule(Seconds(0.0), &TcpTxBufferTestCase::TestTransmittedBlock, this);
     Simulator::Schedule(Seconds(0.0), &TcpTxBufferTestCase::TestNextSeg, this);
+    Simulator::Schedule(Seconds(0.0), &TcpTxBufferTestCase::TestLargeWindowScoreboard, this);
 
     /*
      * Case for transmitted block:
@@ -165,6 +168,74 @@ TcpTxBufferTestCase::TestIsLost()
     }
 }
 
+void
+TcpTxBufferTestCase::TestLargeWindowScoreboard()
+{
+    Ptr<TcpTxBuffer> txBuf = CreateObject<TcpTxBuffer>();
+    txBuf->SetRWndCallback(MakeCallback(&TcpTxBufferTestCase::GetRWnd, this));
+    txBuf->SetHeadSequence(SequenceNumber32(1));
+    txBuf->SetSegmentSize(1000);
+    txBuf->SetDupAckThresh(3);
+    txBuf->SetMaxBufferSize(1000000);
+    txBuf->SetSackEnabled(true);
+
+    // send 1000 segments, of which every tenth one is lost
+    const uint32_t segments = 1000;
+    txBuf->Add(Create<Packet>(segments * 1000));
+    for (uint32_t i = 0; i < segments; ++i)
+    {
+        txBuf->CopyFromSequence(1000, SequenceNumber32(i * 1000 + 1));
+    }
+
+    // the receiver reports the segments after the losses from the highest
+    // to the lowest, one block per ACK
+    for (uint32_t i = segments - 1; i > 0; --i)
+    {
+        if (i % 10 == 0)
+        {
+            continue;
+        }
+        Ptr<TcpOptionSack> sack = CreateObject<TcpOptionSack>();
+        sack->AddSackBlock(TcpOptionSack::SackBlock(SequenceNumber32(i * 1000 + 1),
+                                                    SequenceNumber32(i * 1000 + 1001)));
+        txBuf->Update(sack->GetSackList());
+    }
+
+    // segment 990 has less than three sacked segments above it
+    NS_TEST_ASSERT_MSG_EQ(txBuf->GetSacked(), 900 * 1000, "Wrong sacked count");
+    NS_TEST_ASSERT_MSG_EQ(txBuf->GetLost(), 99 * 1000, "Wrong lost count");
+    NS_TEST_ASSERT_MSG_EQ(txBuf->BytesInFlight(), 1000, "Wrong bytes in flight");
+    for (uint32_t i = 0; i < segments; ++i)
+    {
+        NS_TEST_ASSERT_MSG_EQ(txBuf->IsLost(SequenceNumber32(i * 1000 + 1)),
+                              i % 10 == 0 && i != 990,
+                              "Wrong lost status of segment " << i);
+    }
+
+    // the lost segments are retransmitted in order, then segment 990 by
+    // rule 3 of NextSeg
+    SequenceNumber32 seq;
+    SequenceNumber32 seqHigh;
+    for (uint32_t i = 0; i < segments; i += 10)
+    {
+        NS_TEST_ASSERT_MSG_EQ(txBuf->NextSeg(&seq, &seqHigh, true), true, "No next segment");
+        NS_TEST_ASSERT_MSG_EQ(seq, SequenceNumber32(i * 1000 + 1), "Wrong retransmission");
+        txBuf->CopyFromSequence(1000, seq);
+    }
+    NS_TEST_ASSERT_MSG_EQ(txBuf->GetRetransmitsCount(), 100 * 1000, "Wrong retransmits");
+    NS_TEST_ASSERT_MSG_EQ(txBuf->NextSeg(&seq, &seqHigh, true), false, "No data left to send");
+
+    // a cumulative ACK of the first half, then of everything
+    txBuf->DiscardUpTo(SequenceNumber32(segments / 2 * 1000 + 1));
+    NS_TEST_ASSERT_MSG_EQ(txBuf->GetSacked(), 450 * 1000, "Wrong sacked count");
+    NS_TEST_ASSERT_MSG_EQ(txBuf->GetLost(), 49 * 1000, "Wrong lost count");
+    NS_TEST_ASSERT_MSG_EQ(txBuf->GetRetransmitsCount(), 50 * 1000, "Wrong retransmits");
+    txBuf->DiscardUpTo(SequenceNumber32(segments * 1000 + 1));
+    NS_TEST_ASSERT_MSG_EQ(txBuf->GetSacked(), 0, "Wrong sacked count");
+    NS_TEST_ASSERT_MSG_EQ(txBuf->GetLost(), 0, "Wrong lost count");
+    NS_TEST_ASSERT_MSG_EQ(txBuf->BytesInFlight(), 0, "Wrong bytes in flight");
+}
+
 uint32_t
 TcpTxBufferTestCase::GetRWnd() const
 {
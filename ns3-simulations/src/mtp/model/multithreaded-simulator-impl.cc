@@ -0,0 +1,687 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mtp
+ * Implementation of class ns3::MultithreadedSimulatorImpl.
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/node-list.h"
+#include "ns3/node.h"
+#include "ns3/point-to-point-channel.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+namespace ns3
+{
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions and the possibility
+// of causing recursions leading to stack overflow
+NS_LOG_COMPONENT_DEFINE("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED(MultithreadedSimulatorImpl);
+
+thread_local MultithreadedSimulatorImpl::LogicalProcess* MultithreadedSimulatorImpl::t_current =
+    nullptr;
+
+/** Timestamp of an empty event list. */
+static constexpr uint64_t NEVER = std::numeric_limits<uint64_t>::max();
+
+void
+MultithreadedSimulatorImpl::Barrier::SetCount(uint32_t count)
+{
+    std::unique_lock lock{m_mutex};
+    m_count = count;
+}
+
+void
+MultithreadedSimulatorImpl::Barrier::Wait()
+{
+    std::unique_lock lock{m_mutex};
+    uint64_t generation = m_generation;
+    if (++m_waiting == m_count)
+    {
+        m_waiting = 0;
+        m_generation++;
+        m_cv.notify_all();
+    }
+    else
+    {
+        m_cv.wait(lock, [this, generation]() { return m_generation != generation; });
+    }
+}
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::MultithreadedSimulatorImpl")
+                            .SetParent<SimulatorImpl>()
+                            .SetGroupName("Mtp")
+                            .AddConstructor<MultithreadedSimulatorImpl>();
+    return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl()
+{
+    NS_LOG_FUNCTION(this);
+    m_partitioned = false;
+    m_lookahead = NEVER;
+    m_currentTs = 0;
+    m_stop = false;
+    m_running = false;
+    m_shutdown = false;
+
+    auto lp = std::make_unique<LogicalProcess>();
+    lp->id = 0;
+    lp->uid = EventId::UID::VALID;
+    lp->currentUid = EventId::UID::INVALID;
+    lp->currentTs = 0;
+    lp->currentContext = Simulator::NO_CONTEXT;
+    lp->eventCount = 0;
+    lp->unscheduledEvents = 0;
+    lp->sent = 0;
+    lp->stop = false;
+    lp->stopping = false;
+    lp->next = NEVER;
+    lp->end = NEVER;
+    lp->mailbox = nullptr;
+    m_lps.push_back(std::move(lp));
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    for (auto& lp : m_lps)
+    {
+        ReceiveMessages(*lp);
+        while (!lp->events->IsEmpty())
+        {
+            Scheduler::Event next = lp->events->RemoveNext();
+            next.impl->Unref();
+        }
+        lp->events = nullptr;
+    }
+
+    // the events are released first, so that the workers leave no
+    // event behind in their event pools
+    if (!m_workers.empty())
+    {
+        m_shutdown = true;
+        m_barrier.Wait();
+        for (auto& worker : m_workers)
+        {
+            worker.join();
+        }
+        m_workers.clear();
+    }
+    SimulatorImpl::DoDispose();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy()
+{
+    NS_LOG_FUNCTION(this);
+    while (!m_destroyEvents.empty())
+    {
+        Ptr<EventImpl> ev = m_destroyEvents.front().PeekEventImpl();
+        m_destroyEvents.pop_front();
+        NS_LOG_LOGIC("handle destroy " << ev);
+        if (!ev->IsCancelled())
+        {
+            ev->Invoke();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler(ObjectFactory schedulerFactory)
+{
+    NS_LOG_FUNCTION(this << schedulerFactory);
+    NS_ASSERT_MSG(!m_running, "Cannot change the scheduler while running");
+    m_schedulerFactory = schedulerFactory;
+    for (auto& lp : m_lps)
+    {
+        Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler>();
+        if (lp->events)
+        {
+            while (!lp->events->IsEmpty())
+            {
+                scheduler->Insert(lp->events->RemoveNext());
+            }
+        }
+        lp->events = scheduler;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Partition()
+{
+    NS_LOG_FUNCTION(this);
+    m_partitioned = true;
+
+    uint32_t nLps = 1;
+    m_nodeLp.assign(NodeList::GetNNodes(), 0);
+    for (auto node = NodeList::Begin(); node != NodeList::End(); node++)
+    {
+        uint32_t systemId = (*node)->GetSystemId();
+        m_nodeLp[(*node)->GetId()] = systemId;
+        nLps = std::max(nLps, systemId + 1);
+    }
+
+    // the lookahead is the smallest delay between two partitions
+    m_lookahead = NEVER;
+    for (auto node = NodeList::Begin(); node != NodeList::End(); node++)
+    {
+        for (uint32_t i = 0; i < (*node)->GetNDevices(); i++)
+        {
+            Ptr<NetDevice> device = (*node)->GetDevice(i);
+            Ptr<PointToPointChannel> channel =
+                DynamicCast<PointToPointChannel>(device->GetChannel());
+            if (!channel)
+            {
+                continue;
+            }
+            channel->CacheNodeIds();
+            for (std::size_t j = 0; j < channel->GetNDevices(); j++)
+            {
+                if (channel->GetDevice(j)->GetNode()->GetSystemId() != (*node)->GetSystemId())
+                {
+                    TimeValue delay;
+                    channel->GetAttribute("Delay", delay);
+                    m_lookahead =
+                        std::min(m_lookahead, static_cast<uint64_t>(delay.Get().GetTimeStep()));
+                }
+            }
+        }
+    }
+    NS_ABORT_MSG_IF(m_lookahead == 0, "A link between two partitions has no delay");
+    NS_LOG_INFO(nLps << " partitions, lookahead " << TimeStep(m_lookahead));
+
+    LogicalProcess& first = *m_lps.front();
+    for (uint32_t id = 1; id < nLps; id++)
+    {
+        auto lp = std::make_unique<LogicalProcess>();
+        lp->id = id;
+        lp->events = m_schedulerFactory.Create<Scheduler>();
+        // the events moved below keep their uids
+        lp->uid = first.uid;
+        lp->currentUid = first.currentUid;
+        lp->currentTs = first.currentTs;
+        lp->currentContext = Simulator::NO_CONTEXT;
+        lp->eventCount = 0;
+        lp->unscheduledEvents = 0;
+        lp->sent = 0;
+        lp->stop = false;
+        lp->stopping = false;
+        lp->next = NEVER;
+        lp->end = NEVER;
+        lp->mailbox = nullptr;
+        m_lps.push_back(std::move(lp));
+    }
+
+    // move the events scheduled so far to their partition
+    std::vector<Scheduler::Event> events;
+    while (!first.events->IsEmpty())
+    {
+        events.push_back(first.events->RemoveNext());
+    }
+    first.unscheduledEvents = 0;
+    for (const auto& ev : events)
+    {
+        LogicalProcess& lp = GetLogicalProcess(ev.key.m_context);
+        lp.events->Insert(ev);
+        lp.unscheduledEvents++;
+    }
+}
+
+MultithreadedSimulatorImpl::LogicalProcess&
+MultithreadedSimulatorImpl::GetLogicalProcess(uint32_t context) const
+{
+    if (context < m_nodeLp.size())
+    {
+        return *m_lps[m_nodeLp[context]];
+    }
+    return *m_lps.front();
+}
+
+EventId
+MultithreadedSimulatorImpl::Insert(LogicalProcess& lp,
+                                   uint64_t ts,
+                                   uint32_t context,
+                                   EventImpl* event)
+{
+    Scheduler::Event ev;
+    ev.impl = event;
+    ev.key.m_ts = ts;
+    ev.key.m_context = context;
+    ev.key.m_uid = lp.uid;
+    lp.uid++;
+    lp.unscheduledEvents++;
+    lp.events->Insert(ev);
+    return EventId(event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+void
+MultithreadedSimulatorImpl::Send(LogicalProcess& lp, Message* message)
+{
+    message->next = lp.mailbox.load(std::memory_order_relaxed);
+    while (!lp.mailbox.compare_exchange_weak(message->next,
+                                             message,
+                                             std::memory_order_release,
+                                             std::memory_order_relaxed))
+    {
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ReceiveMessages(LogicalProcess& lp)
+{
+    Message* head = lp.mailbox.exchange(nullptr, std::memory_order_acquire);
+    if (head == nullptr)
+    {
+        return;
+    }
+    std::vector<Message*> messages;
+    for (Message* m = head; m != nullptr; m = m->next)
+    {
+        messages.push_back(m);
+    }
+    // the mailbox is last in, first out; the order of the messages of
+    // the logical processes does not depend on the thread timings
+    std::reverse(messages.begin(), messages.end());
+    std::stable_sort(messages.begin(), messages.end(), [](const Message* a, const Message* b) {
+        return a->source < b->source || (a->source == b->source && a->seq < b->seq);
+    });
+    for (Message* m : messages)
+    {
+        // the messages of other threads hold a delay
+        uint64_t ts = m->source == FOREIGN ? lp.currentTs + m->ts : m->ts;
+        Insert(lp, ts, m->context, m->event);
+        delete m;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::RunLogicalProcess(LogicalProcess& lp)
+{
+    t_current = &lp;
+    while (true)
+    {
+        ReceiveMessages(lp);
+        lp.next = lp.events->IsEmpty() ? NEVER : lp.events->PeekNext().key.m_ts;
+        lp.stopping = lp.stop || (lp.id == 0 && m_stop.load(std::memory_order_relaxed));
+        m_barrier.Wait();
+
+        // every thread reaches the same decision, as the values read
+        // here are only written before the barrier
+        uint64_t next = NEVER;
+        bool stop = false;
+        for (const auto& other : m_lps)
+        {
+            next = std::min(next, other->next);
+            stop = stop || other->stopping;
+        }
+        if (next == NEVER || stop)
+        {
+            break;
+        }
+        lp.end = next < NEVER - m_lookahead ? next + m_lookahead : NEVER;
+
+        while (!lp.stop && !lp.events->IsEmpty() && lp.events->PeekNext().key.m_ts < lp.end)
+        {
+            Scheduler::Event ev = lp.events->RemoveNext();
+
+            PreEventHook(EventId(ev.impl, ev.key.m_ts, ev.key.m_context, ev.key.m_uid));
+
+            NS_ASSERT(ev.key.m_ts >= lp.currentTs);
+            lp.unscheduledEvents--;
+            lp.eventCount++;
+            lp.currentTs = ev.key.m_ts;
+            lp.currentContext = ev.key.m_context;
+            lp.currentUid = ev.key.m_uid;
+            ev.impl->Invoke();
+            ev.impl->Unref();
+        }
+        // all the messages of the window are sent past this barrier
+        m_barrier.Wait();
+    }
+    t_current = nullptr;
+}
+
+void
+MultithreadedSimulatorImpl::Worker(LogicalProcess& lp)
+{
+    while (true)
+    {
+        m_barrier.Wait();
+        if (m_shutdown)
+        {
+            break;
+        }
+        RunLogicalProcess(lp);
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished() const
+{
+    if (m_stop)
+    {
+        return true;
+    }
+    for (const auto& lp : m_lps)
+    {
+        if (!lp->events->IsEmpty() || lp->mailbox.load() != nullptr)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void
+MultithreadedSimulatorImpl::Run()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT_MSG(t_current == nullptr && !m_running, "Simulator::Run called recursively");
+    if (!m_partitioned)
+    {
+        Partition();
+    }
+
+    m_stop = false;
+    for (auto& lp : m_lps)
+    {
+        lp->stop = false;
+    }
+    m_running = true;
+    if (m_lps.size() > 1)
+    {
+        if (m_workers.empty())
+        {
+            m_barrier.SetCount(m_lps.size());
+            for (std::size_t i = 1; i < m_lps.size(); i++)
+            {
+                m_workers.emplace_back(&MultithreadedSimulatorImpl::Worker,
+                                       this,
+                                       std::ref(*m_lps[i]));
+            }
+        }
+        // start the workers
+        m_barrier.Wait();
+    }
+    RunLogicalProcess(*m_lps.front());
+    m_running = false;
+
+    // outside of Run(), the time is that of the furthest partition
+    bool empty = true;
+    for (auto& lp : m_lps)
+    {
+        m_currentTs = std::max(m_currentTs, lp->currentTs);
+        empty = empty && lp->events->IsEmpty();
+    }
+    if (empty)
+    {
+        // If the simulator stopped naturally by lack of events, make a
+        // consistency test to check that we didn't lose any events along the way.
+        for (auto& lp : m_lps)
+        {
+            NS_ASSERT(lp->unscheduledEvents == 0);
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Stop()
+{
+    NS_LOG_FUNCTION(this);
+    if (t_current != nullptr)
+    {
+        t_current->stop = true;
+    }
+    m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop(const Time& delay)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep());
+    Simulator::Schedule(delay, &Simulator::Stop);
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule(const Time& delay, EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep() << event);
+    NS_ASSERT_MSG(delay.IsPositive(), "MultithreadedSimulatorImpl::Schedule(): Negative delay");
+
+    LogicalProcess* lp = t_current;
+    if (lp == nullptr)
+    {
+        NS_ASSERT_MSG(!m_running, "Simulator::Schedule Thread-unsafe invocation!");
+        return Insert(*m_lps.front(),
+                      m_currentTs + delay.GetTimeStep(),
+                      Simulator::NO_CONTEXT,
+                      event);
+    }
+    return Insert(*lp, lp->currentTs + delay.GetTimeStep(), lp->currentContext, event);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext(uint32_t context,
+                                                const Time& delay,
+                                                EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << context << delay.GetTimeStep() << event);
+
+    LogicalProcess& dst = GetLogicalProcess(context);
+    LogicalProcess* src = t_current;
+    if (src == &dst)
+    {
+        Insert(dst, src->currentTs + delay.GetTimeStep(), context, event);
+    }
+    else if (src != nullptr)
+    {
+        auto message = new Message;
+        message->ts = src->currentTs + delay.GetTimeStep();
+        message->context = context;
+        message->source = src->id;
+        message->seq = src->sent++;
+        message->event = event;
+        // an event in the current window of the other partition would be
+        // in its past by the time it is received
+        NS_ABORT_MSG_IF(message->ts < src->end,
+                        "Event scheduled in another partition within the lookahead: context "
+                            << context << " at " << TimeStep(message->ts) << ", window ends at "
+                            << TimeStep(src->end));
+        Send(dst, message);
+    }
+    else if (m_running)
+    {
+        // from a thread other than those of the simulation
+        auto message = new Message;
+        message->ts = delay.GetTimeStep();
+        message->context = context;
+        message->source = FOREIGN;
+        message->seq = 0;
+        message->event = event;
+        Send(dst, message);
+    }
+    else
+    {
+        Insert(dst, m_currentTs + delay.GetTimeStep(), context, event);
+    }
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow(EventImpl* event)
+{
+    return Schedule(Time(0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy(EventImpl* event)
+{
+    std::unique_lock lock{m_destroyEventsMutex};
+    EventId id(Ptr<EventImpl>(event, false), Now().GetTimeStep(), 0xffffffff, 2);
+    m_destroyEvents.push_back(id);
+    return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now() const
+{
+    // Do not add function logging here, to avoid stack overflow
+    return TimeStep(t_current != nullptr ? t_current->currentTs : m_currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft(const EventId& id) const
+{
+    if (IsExpired(id))
+    {
+        return TimeStep(0);
+    }
+    uint64_t now = Now().GetTimeStep();
+    return TimeStep(id.GetTs() > now ? id.GetTs() - now : 0);
+}
+
+void
+MultithreadedSimulatorImpl::Remove(const EventId& id)
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        // destroy events.
+        std::unique_lock lock{m_destroyEventsMutex};
+        for (auto i = m_destroyEvents.begin(); i != m_destroyEvents.end(); i++)
+        {
+            if (*i == id)
+            {
+                m_destroyEvents.erase(i);
+                break;
+            }
+        }
+        return;
+    }
+    if (IsExpired(id))
+    {
+        return;
+    }
+    LogicalProcess& lp = GetLogicalProcess(id.GetContext());
+    NS_ASSERT_MSG(!m_running || t_current == &lp, "Cannot remove an event of another partition");
+    Scheduler::Event event;
+    event.impl = id.PeekEventImpl();
+    event.key.m_ts = id.GetTs();
+    event.key.m_context = id.GetContext();
+    event.key.m_uid = id.GetUid();
+    lp.events->Remove(event);
+    event.impl->Cancel();
+    // whenever we remove an event from the event list, we have to unref it.
+    event.impl->Unref();
+
+    lp.unscheduledEvents--;
+}
+
+void
+MultithreadedSimulatorImpl::Cancel(const EventId& id)
+{
+    if (!IsExpired(id))
+    {
+        id.PeekEventImpl()->Cancel();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired(const EventId& id) const
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        if (id.PeekEventImpl() == nullptr || id.PeekEventImpl()->IsCancelled())
+        {
+            return true;
+        }
+        // destroy events.
+        std::unique_lock lock{m_destroyEventsMutex};
+        for (auto i = m_destroyEvents.begin(); i != m_destroyEvents.end(); i++)
+        {
+            if (*i == id)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    const LogicalProcess& lp = GetLogicalProcess(id.GetContext());
+    return id.PeekEventImpl() == nullptr || id.GetTs() < lp.currentTs ||
+           (id.GetTs() == lp.currentTs && id.GetUid() <= lp.currentUid) ||
+           id.PeekEventImpl()->IsCancelled();
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime() const
+{
+    return TimeStep(0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId() const
+{
+    return t_current != nullptr ? t_current->id : 0;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext() const
+{
+    return t_current != nullptr ? t_current->currentContext : Simulator::NO_CONTEXT;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount() const
+{
+    uint64_t count = 0;
+    for (const auto& lp : m_lps)
+    {
+        count += lp->eventCount;
+    }
+    return count;
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookahead() const
+{
+    return TimeStep(m_lookahead);
+}
+
+} // namespace ns3
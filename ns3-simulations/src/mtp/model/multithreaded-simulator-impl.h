@@ -0,0 +1,250 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+/**
+ * \file
+ * \ingroup mtp
+ * Declaration of class ns3::MultithreadedSimulatorImpl.
+ */
+
+#ifndef NS3_MULTITHREADED_SIMULATOR_IMPL_H
+#define NS3_MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/event-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/ptr.h"
+#include "ns3/scheduler.h"
+#include "ns3/simulator-impl.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \defgroup mtp Multithreaded simulation
+ *
+ * Conservative parallel simulation of a partitioned topology on the
+ * threads of a single process.
+ */
+
+/**
+ * \ingroup mtp
+ *
+ * \brief Shared-memory parallel simulator implementation.
+ *
+ * The nodes are partitioned by their system id, as with the
+ * DistributedSimulatorImpl, but every partition (logical process) runs
+ * on a thread of the same process. Each logical process has its own
+ * event list, clock and event uids.
+ *
+ * The logical processes advance in windows. At the start of a window
+ * they agree on the time of the earliest pending event, T, and each of
+ * them then runs its events earlier than T + lookahead, where the
+ * lookahead is the smallest delay of the PointToPointChannel links
+ * between nodes of different system ids: no event of a window can
+ * schedule an event in another logical process before the window ends.
+ * Such an event is pushed on the lock-free mailbox of its logical
+ * process, and inserted in its event list in a deterministic order at
+ * the end of the window, so that the simulation is reproducible.
+ *
+ * Simulator::Stop() takes effect at the end of the window, so the
+ * other logical processes may run up to lookahead past the stop time.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    MultithreadedSimulatorImpl();
+    /** Destructor. */
+    ~MultithreadedSimulatorImpl() override;
+
+    // Inherited
+    void Destroy() override;
+    bool IsFinished() const override;
+    void Stop() override;
+    void Stop(const Time& delay) override;
+    EventId Schedule(const Time& delay, EventImpl* event) override;
+    void ScheduleWithContext(uint32_t context, const Time& delay, EventImpl* event) override;
+    EventId ScheduleNow(EventImpl* event) override;
+    EventId ScheduleDestroy(EventImpl* event) override;
+    void Remove(const EventId& id) override;
+    void Cancel(const EventId& id) override;
+    bool IsExpired(const EventId& id) const override;
+    void Run() override;
+    Time Now() const override;
+    Time GetDelayLeft(const EventId& id) const override;
+    Time GetMaximumSimulationTime() const override;
+    void SetScheduler(ObjectFactory schedulerFactory) override;
+    uint32_t GetSystemId() const override;
+    uint32_t GetContext() const override;
+    uint64_t GetEventCount() const override;
+
+    /**
+     * Get the lookahead used by the last Run().
+     *
+     * \return The lookahead.
+     */
+    Time GetLookahead() const;
+
+  private:
+    void DoDispose() override;
+
+    /** An event sent to another logical process. */
+    struct Message
+    {
+        uint64_t ts;      //!< Event timestamp.
+        uint32_t context; //!< Event context.
+        uint32_t source;  //!< Sending logical process, FOREIGN from other threads.
+        uint64_t seq;     //!< Send order in the sending logical process.
+        EventImpl* event; //!< The event implementation.
+        Message* next;    //!< Next message of the mailbox.
+    };
+
+    /** A partition of the simulation, run by a thread. */
+    struct alignas(64) LogicalProcess
+    {
+        uint32_t id;                    //!< Index, and system id.
+        Ptr<Scheduler> events;          //!< The event priority queue.
+        uint32_t uid;                   //!< Next event unique id.
+        uint32_t currentUid;            //!< Unique id of the current event.
+        uint64_t currentTs;             //!< Timestamp of the current event.
+        uint32_t currentContext;        //!< Execution context of the current event.
+        uint64_t eventCount;            //!< The event count.
+        int unscheduledEvents;          //!< Number of events in the event list.
+        uint64_t sent;                  //!< Number of messages sent.
+        bool stop;                      //!< Stop() called by one of the events.
+        bool stopping;                  //!< Value of stop published at the barrier.
+        uint64_t next;                  //!< Timestamp of the next event, at the barrier.
+        uint64_t end;                   //!< End of the current window.
+        std::atomic<Message*> mailbox;  //!< Messages received, last first.
+    };
+
+    /** Reusable barrier for the threads of the logical processes. */
+    class Barrier
+    {
+      public:
+        /**
+         * Set the number of threads.
+         * \param [in] count The number of threads.
+         */
+        void SetCount(uint32_t count);
+        /** Wait until all the threads reached the barrier. */
+        void Wait();
+
+      private:
+        std::mutex m_mutex;             //!< Protects the state.
+        std::condition_variable m_cv;   //!< Signals a new generation.
+        uint32_t m_count{1};            //!< Number of threads.
+        uint32_t m_waiting{0};          //!< Threads waiting.
+        uint64_t m_generation{0};       //!< Barrier uses.
+    };
+
+    /**
+     * Partition the nodes by system id and compute the lookahead.
+     * Called by the first Run().
+     */
+    void Partition();
+    /**
+     * \param [in] context An event context.
+     * \return The logical process of the context.
+     */
+    LogicalProcess& GetLogicalProcess(uint32_t context) const;
+    /**
+     * Insert an event in the event list of a logical process.
+     * \param [in] lp The logical process.
+     * \param [in] ts The event timestamp.
+     * \param [in] context The event context.
+     * \param [in] event The event implementation.
+     * \return The event id.
+     */
+    EventId Insert(LogicalProcess& lp, uint64_t ts, uint32_t context, EventImpl* event);
+    /**
+     * Send an event to another logical process.
+     * \param [in] lp The destination logical process.
+     * \param [in] message The message.
+     */
+    void Send(LogicalProcess& lp, Message* message);
+    /**
+     * Insert the events received by a logical process in its event list.
+     * \param [in] lp The logical process.
+     */
+    void ReceiveMessages(LogicalProcess& lp);
+    /**
+     * Run the windows of a logical process until the end of the
+     * simulation or Stop().
+     * \param [in] lp The logical process.
+     */
+    void RunLogicalProcess(LogicalProcess& lp);
+    /**
+     * Body of the threads of the logical processes other than the first,
+     * which runs on the thread calling Run().
+     * \param [in] lp The logical process.
+     */
+    void Worker(LogicalProcess& lp);
+
+    /** Sending logical process of the messages from other threads. */
+    static constexpr uint32_t FOREIGN = 0xffffffff;
+
+    /** The logical process of the calling thread, while running. */
+    static thread_local LogicalProcess* t_current;
+
+    /** The logical processes. */
+    std::vector<std::unique_ptr<LogicalProcess>> m_lps;
+    /** Logical process of each node. */
+    std::vector<uint32_t> m_nodeLp;
+    /** The nodes have been partitioned. */
+    bool m_partitioned;
+    /** Lookahead, in time steps. */
+    uint64_t m_lookahead;
+    /** The scheduler type of the event lists. */
+    ObjectFactory m_schedulerFactory;
+    /** Timestamp outside of Run(). */
+    uint64_t m_currentTs;
+    /** Flag calling for the end of the simulation. */
+    std::atomic<bool> m_stop;
+    /** Run() is in progress. */
+    bool m_running;
+
+    /** Container type for the events to run at Simulator::Destroy() */
+    typedef std::list<EventId> DestroyEvents;
+    /** The container of events to run at Destroy. */
+    DestroyEvents m_destroyEvents;
+    /** Protects m_destroyEvents. */
+    mutable std::mutex m_destroyEventsMutex;
+
+    /** Threads of the logical processes other than the first. */
+    std::vector<std::thread> m_workers;
+    /** The workers are to exit. */
+    bool m_shutdown;
+    /** Synchronizes the windows. */
+    Barrier m_barrier;
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_SIMULATOR_IMPL_H */
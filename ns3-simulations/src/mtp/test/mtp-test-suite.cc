@@ -0,0 +1,317 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/global-value.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/node-container.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup mtp
+ * MultithreadedSimulatorImpl test suite.
+ */
+
+using namespace ns3;
+
+/**
+ * \ingroup mtp
+ * \ingroup tests
+ *
+ * Packets sent from both ends of a line of nodes, and relayed back and
+ * forth along the line, are received at the same times as with the
+ * default simulator implementation, in every run of the multithreaded
+ * simulator.
+ */
+class MultithreadedSimulatorTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param [in] nNodes The number of nodes of the line.
+     * \param [in] nPartitions The number of partitions, of consecutive nodes.
+     * \param [in] nPackets The number of packets sent from each end.
+     * \param [in] dataRate The data rate of the links.
+     * \param [in] interval The interval between two packets sent from an end.
+     * \param [in] nRuns The number of runs of the multithreaded simulator.
+     */
+    MultithreadedSimulatorTestCase(uint32_t nNodes,
+                                   uint32_t nPartitions,
+                                   uint32_t nPackets,
+                                   std::string dataRate,
+                                   Time interval,
+                                   uint32_t nRuns);
+
+  private:
+    void DoRun() override;
+
+    /** Receptions of a node: time and size of each packet. */
+    typedef std::vector<std::pair<Time, uint32_t>> Receptions;
+
+    /**
+     * Simulate the line.
+     * \param [in] implementation The simulator implementation type.
+     * \return The receptions of every node.
+     */
+    std::vector<Receptions> Simulate(std::string implementation);
+    /**
+     * Send a packet from an end of the line.
+     * \param [in] device The device sending the packet.
+     * \param [in] size The packet size.
+     */
+    void Send(Ptr<NetDevice> device, uint32_t size);
+    /**
+     * Relay a packet to the next node, back to the first node from the last.
+     * \param [in] device The receiving device.
+     * \param [in] packet The packet.
+     * \param [in] protocol The protocol number.
+     * \param [in] from The sender address.
+     * \return \c true.
+     */
+    bool Receive(Ptr<NetDevice> device,
+                 Ptr<const Packet> packet,
+                 uint16_t protocol,
+                 const Address& from);
+
+    uint32_t m_nNodes;                    //!< Number of nodes.
+    uint32_t m_nPartitions;               //!< Number of partitions.
+    uint32_t m_nPackets;                  //!< Number of packets sent from each end.
+    std::string m_dataRate;               //!< Data rate of the links.
+    Time m_interval;                      //!< Interval between two packets sent from an end.
+    uint32_t m_nRuns;                     //!< Number of runs of the multithreaded simulator.
+    std::vector<Ptr<NetDevice>> m_left;   //!< Device of each node toward the first node.
+    std::vector<Ptr<NetDevice>> m_right;  //!< Device of each node toward the last node.
+    std::vector<Receptions> m_receptions; //!< Receptions of each node.
+    /**
+     * Simulator::GetSystemId() was right on each node. Not a vector of
+     * bool, whose elements are not distinct objects for the threads.
+     */
+    std::vector<uint8_t> m_systemIds;
+};
+
+MultithreadedSimulatorTestCase::MultithreadedSimulatorTestCase(uint32_t nNodes,
+                                                               uint32_t nPartitions,
+                                                               uint32_t nPackets,
+                                                               std::string dataRate,
+                                                               Time interval,
+                                                               uint32_t nRuns)
+    : TestCase("Check the multithreaded simulator against the default simulator, " +
+               std::to_string(nNodes) + " nodes in " + std::to_string(nPartitions) +
+               " partitions"),
+      m_nNodes(nNodes),
+      m_nPartitions(nPartitions),
+      m_nPackets(nPackets),
+      m_dataRate(dataRate),
+      m_interval(interval),
+      m_nRuns(nRuns)
+{
+}
+
+void
+MultithreadedSimulatorTestCase::Send(Ptr<NetDevice> device, uint32_t size)
+{
+    device->Send(Create<Packet>(size), device->GetBroadcast(), 0x0800);
+}
+
+bool
+MultithreadedSimulatorTestCase::Receive(Ptr<NetDevice> device,
+                                        Ptr<const Packet> packet,
+                                        uint16_t protocol,
+                                        const Address& from)
+{
+    // every node is only accessed by the thread of its partition
+    uint32_t node = device->GetNode()->GetId();
+    m_receptions[node].emplace_back(Simulator::Now(), packet->GetSize());
+    if (Simulator::GetSystemId() != device->GetNode()->GetSystemId())
+    {
+        m_systemIds[node] = 0;
+    }
+
+    Ptr<NetDevice> next;
+    if (device == m_left[node])
+    {
+        next = m_right[node] ? m_right[node] : m_left[node];
+    }
+    else if (m_left[node])
+    {
+        next = m_left[node];
+    }
+    if (next)
+    {
+        next->Send(packet->Copy(), next->GetBroadcast(), protocol);
+    }
+    return true;
+}
+
+std::vector<MultithreadedSimulatorTestCase::Receptions>
+MultithreadedSimulatorTestCase::Simulate(std::string implementation)
+{
+    const uint32_t nNodes = m_nNodes;
+
+    GlobalValue::Bind("SimulatorImplementationType", StringValue(implementation));
+
+    NodeContainer nodes;
+    for (uint32_t i = 0; i < nNodes; i++)
+    {
+        nodes.Create(1, i * m_nPartitions / nNodes);
+    }
+    m_left.assign(nNodes, nullptr);
+    m_right.assign(nNodes, nullptr);
+    m_receptions.assign(nNodes, Receptions());
+    m_systemIds.assign(nNodes, 1);
+
+    PointToPointHelper p2p;
+    p2p.SetDeviceAttribute("DataRate", StringValue(m_dataRate));
+    Time lookahead = Time::Max();
+    for (uint32_t i = 0; i + 1 < nNodes; i++)
+    {
+        Time delay = MilliSeconds(2 + i % 3);
+        if (nodes.Get(i)->GetSystemId() != nodes.Get(i + 1)->GetSystemId())
+        {
+            lookahead = std::min(lookahead, delay);
+        }
+        p2p.SetChannelAttribute("Delay", TimeValue(delay));
+        NetDeviceContainer devices = p2p.Install(nodes.Get(i), nodes.Get(i + 1));
+        m_right[i] = devices.Get(0);
+        m_left[i + 1] = devices.Get(1);
+    }
+    for (uint32_t i = 0; i < nNodes; i++)
+    {
+        for (const auto& device : {m_left[i], m_right[i]})
+        {
+            if (device)
+            {
+                device->SetReceiveCallback(
+                    MakeCallback(&MultithreadedSimulatorTestCase::Receive, this));
+            }
+        }
+    }
+
+    // enough packets for the queues to build up
+    for (uint32_t i = 0; i < m_nPackets; i++)
+    {
+        Simulator::ScheduleWithContext(nodes.Get(0)->GetId(),
+                                       m_interval * i,
+                                       &MultithreadedSimulatorTestCase::Send,
+                                       this,
+                                       m_right[0],
+                                       100 + i % 50 * 10);
+        Simulator::ScheduleWithContext(nodes.Get(nNodes - 1)->GetId(),
+                                       m_interval * i,
+                                       &MultithreadedSimulatorTestCase::Send,
+                                       this,
+                                       m_left[nNodes - 1],
+                                       600 + i % 40 * 10);
+    }
+    Simulator::Stop(Seconds(10));
+    Simulator::Run();
+
+    Ptr<MultithreadedSimulatorImpl> mtp =
+        DynamicCast<MultithreadedSimulatorImpl>(Simulator::GetImplementation());
+    if (implementation == "ns3::MultithreadedSimulatorImpl")
+    {
+        NS_TEST_EXPECT_MSG_NE(mtp, nullptr, "Wrong simulator implementation");
+        NS_TEST_EXPECT_MSG_EQ(mtp->GetLookahead(), lookahead, "Wrong lookahead");
+    }
+
+    m_left.clear();
+    m_right.clear();
+    Simulator::Destroy();
+    return m_receptions;
+}
+
+void
+MultithreadedSimulatorTestCase::DoRun()
+{
+    std::vector<Receptions> sequential = Simulate("ns3::DefaultSimulatorImpl");
+    NS_TEST_ASSERT_MSG_GT(sequential[0].size(), 0, "No packet made it back");
+
+    // The packets arriving at the same time from both neighbours of a node
+    // may be received in another order than with the sequential simulator,
+    // so the comparison with it ignores the order of simultaneous receptions.
+    // The multithreaded runs must all match the first one exactly.
+    std::vector<Receptions> first;
+    for (uint32_t run = 0; run < m_nRuns; run++)
+    {
+        std::vector<Receptions> receptions = Simulate("ns3::MultithreadedSimulatorImpl");
+        GlobalValue::Bind("SimulatorImplementationType",
+                          StringValue("ns3::DefaultSimulatorImpl"));
+
+        std::vector<Receptions> expected = run == 0 ? sequential : first;
+        std::vector<Receptions> actual = receptions;
+        for (uint32_t i = 0; i < expected.size(); i++)
+        {
+            NS_TEST_EXPECT_MSG_EQ(+m_systemIds[i],
+                                  1,
+                                  "Event of node " << i << " in another thread");
+            NS_TEST_ASSERT_MSG_EQ(actual[i].size(),
+                                  expected[i].size(),
+                                  "Wrong number of packets received by node "
+                                      << i << " in run " << run);
+            if (run == 0)
+            {
+                std::sort(expected[i].begin(), expected[i].end());
+                std::sort(actual[i].begin(), actual[i].end());
+            }
+            for (uint32_t j = 0; j < expected[i].size(); j++)
+            {
+                NS_TEST_EXPECT_MSG_EQ(actual[i][j].first,
+                                      expected[i][j].first,
+                                      "Wrong reception time of packet "
+                                          << j << " on node " << i << " in run " << run);
+                NS_TEST_EXPECT_MSG_EQ(actual[i][j].second,
+                                      expected[i][j].second,
+                                      "Wrong size of packet " << j << " on node " << i
+                                                              << " in run " << run);
+            }
+        }
+        if (run == 0)
+        {
+            first = receptions;
+        }
+    }
+}
+
+/**
+ * \ingroup mtp
+ * \ingroup tests
+ *
+ * MultithreadedSimulatorImpl test suite.
+ */
+class MtpTestSuite : public TestSuite
+{
+  public:
+    MtpTestSuite()
+        : TestSuite("mtp", UNIT)
+    {
+        // a partition per node, without queueing
+        AddTestCase(new MultithreadedSimulatorTestCase(4, 4, 50, "1Mbps", MicroSeconds(300), 1),
+                    TestCase::QUICK);
+        // several nodes per partition, loaded links, repeated runs
+        AddTestCase(
+            new MultithreadedSimulatorTestCase(12, 4, 2000, "10Mbps", MicroSeconds(200), 5),
+            TestCase::QUICK);
+    }
+};
+
+static MtpTestSuite g_mtpTestSuite; //!< Static variable for test initialization
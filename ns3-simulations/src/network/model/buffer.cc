@@ -54,7 +54,49 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("Buffer");
 
-uint32_t Buffer::g_recommendedStart = 0;
+constexpr uint32_t ALLOC_OVER_PROVISION = 100; //!< Additional bytes to over-provision.
+
+thread_local uint32_t Buffer::g_recommendedStart = 0;
+uint32_t Buffer::g_headroom = 64;
+thread_local Buffer::Stats Buffer::g_stats = {0, 0, 0, 0};
+
+Buffer::Stats
+Buffer::GetStats()
+{
+    return g_stats;
+}
+
+void
+Buffer::ResetStats()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    g_stats = {0, 0, 0, 0};
+}
+
+void
+Buffer::SetHeadroom(uint32_t headroom)
+{
+    NS_LOG_FUNCTION(headroom);
+    g_headroom = headroom;
+}
+
+uint32_t
+Buffer::GetHeadroom()
+{
+    return g_headroom;
+}
+
+uint32_t
+Buffer::GetSizeClass(uint32_t size)
+{
+    uint32_t sizeClass = 0;
+    while (sizeClass < N_SIZE_CLASSES && (MIN_CLASS_SIZE << sizeClass) < size)
+    {
+        sizeClass++;
+    }
+    return sizeClass;
+}
+
 #ifdef BUFFER_FREE_LIST
 /* The following macros are pretty evil but they are needed to allow us to
  * keep track of 3 possible states for the g_freeList variable:
@@ -79,18 +121,20 @@ uint32_t Buffer::g_recommendedStart = 0;
 #define IS_INITIALIZED(x) (!IS_UNINITIALIZED(x) && !IS_DESTROYED(x))
 #define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
 #define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList* Buffer::g_freeList = nullptr;
-Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
+thread_local Buffer::FreeList* Buffer::g_freeList = nullptr;
+thread_local Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
 
 Buffer::LocalStaticDestructor::~LocalStaticDestructor()
 {
     NS_LOG_FUNCTION(this);
     if (IS_INITIALIZED(g_freeList))
     {
-        for (auto i = g_freeList->begin(); i != g_freeList->end(); i++)
+        for (auto& list : *g_freeList)
         {
-            Buffer::Deallocate(*i);
+            for (auto i = list.begin(); i != list.end(); i++)
+            {
+                Buffer::Deallocate(*i);
+            }
         }
         delete g_freeList;
         g_freeList = DESTROYED;
@@ -103,16 +147,20 @@ Buffer::Recycle(Buffer::Data* data)
     NS_LOG_FUNCTION(data);
     NS_ASSERT(data->m_count == 0);
     NS_ASSERT(!IS_UNINITIALIZED(g_freeList));
-    g_maxSize = std::max(g_maxSize, data->m_size);
-    /* feed into free list */
-    if (data->m_size < g_maxSize || IS_DESTROYED(g_freeList) || g_freeList->size() > 1000)
+    /* feed into the free list of its size class. The storages are
+     * allocated with the exact size of their class, other sizes are
+     * larger than all of the classes.
+     */
+    uint32_t sizeClass = GetSizeClass(data->m_size);
+    if (sizeClass == N_SIZE_CLASSES || IS_DESTROYED(g_freeList) ||
+        (*g_freeList)[sizeClass].size() > 1000)
     {
         Buffer::Deallocate(data);
     }
     else
     {
         NS_ASSERT(IS_INITIALIZED(g_freeList));
-        g_freeList->push_back(data);
+        (*g_freeList)[sizeClass].push_back(data);
     }
 }
 
@@ -120,23 +168,25 @@ Buffer::Data*
 Buffer::Create(uint32_t dataSize)
 {
     NS_LOG_FUNCTION(dataSize);
-    /* try to find a buffer correctly sized. */
+    /* try to find a buffer of the size class of the request. */
     if (IS_UNINITIALIZED(g_freeList))
     {
         g_freeList = new Buffer::FreeList();
+        // the free lists are per thread: this constructs the destructor
+        // of the list of the calling thread
+        (void)&g_localStaticDestructor;
     }
     else if (IS_INITIALIZED(g_freeList))
     {
-        while (!g_freeList->empty())
+        uint32_t sizeClass = GetSizeClass(dataSize + ALLOC_OVER_PROVISION);
+        if (sizeClass < N_SIZE_CLASSES && !(*g_freeList)[sizeClass].empty())
         {
-            Buffer::Data* data = g_freeList->back();
-            g_freeList->pop_back();
-            if (data->m_size >= dataSize)
-            {
-                data->m_count = 1;
-                return data;
-            }
-            Buffer::Deallocate(data);
+            Buffer::Data* data = (*g_freeList)[sizeClass].back();
+            (*g_freeList)[sizeClass].pop_back();
+            NS_ASSERT(data->m_size >= dataSize);
+            data->m_count = 1;
+            g_stats.recycled++;
+            return data;
         }
     }
     Buffer::Data* data = Buffer::Allocate(dataSize);
@@ -160,8 +210,6 @@ Buffer::Create(uint32_t size)
 }
 #endif /* BUFFER_FREE_LIST */
 
-constexpr uint32_t ALLOC_OVER_PROVISION = 100; //!< Additional bytes to over-provision.
-
 Buffer::Data*
 Buffer::Allocate(uint32_t reqSize)
 {
@@ -172,11 +220,18 @@ Buffer::Allocate(uint32_t reqSize)
     }
     NS_ASSERT(reqSize >= 1);
     reqSize += ALLOC_OVER_PROVISION;
+    // round up to the size class, for the storage to be recycled
+    uint32_t sizeClass = GetSizeClass(reqSize);
+    if (sizeClass < N_SIZE_CLASSES)
+    {
+        reqSize = MIN_CLASS_SIZE << sizeClass;
+    }
     uint32_t size = reqSize - 1 + sizeof(Buffer::Data);
     auto b = new uint8_t[size];
     auto data = reinterpret_cast<Buffer::Data*>(b);
     data->m_size = reqSize;
     data->m_count = 1;
+    g_stats.allocations++;
     return data;
 }
 
@@ -248,8 +303,8 @@ void
 Buffer::Initialize(uint32_t zeroSize)
 {
     NS_LOG_FUNCTION(this << zeroSize);
-    m_data = Buffer::Create(0);
-    m_start = std::min(m_data->m_size, g_recommendedStart);
+    m_data = Buffer::Create(g_headroom);
+    m_start = std::min(m_data->m_size, std::max(g_recommendedStart, g_headroom));
     m_maxZeroAreaStart = m_start;
     m_zeroAreaStart = m_start;
     m_zeroAreaEnd = m_zeroAreaStart + zeroSize;
@@ -330,9 +385,19 @@ Buffer::AddAtStart(uint32_t start)
     }
     else
     {
-        uint32_t newSize = GetInternalSize() + start;
+        if (isDirty)
+        {
+            g_stats.copies++;
+        }
+        else
+        {
+            g_stats.reallocations++;
+        }
+        // keep the headroom in front of the new data, for the next headers
+        uint32_t newStart = start + g_headroom;
+        uint32_t newSize = GetInternalSize() + newStart;
         Buffer::Data* newData = Buffer::Create(newSize);
-        memcpy(newData->m_data + start, m_data->m_data + m_start, GetInternalSize());
+        memcpy(newData->m_data + newStart, m_data->m_data + m_start, GetInternalSize());
         m_data->m_count--;
         if (m_data->m_count == 0)
         {
@@ -340,7 +405,7 @@ Buffer::AddAtStart(uint32_t start)
         }
         m_data = newData;
 
-        int32_t delta = start - m_start;
+        int32_t delta = newStart - m_start;
         m_start += delta;
         m_zeroAreaStart += delta;
         m_zeroAreaEnd += delta;
@@ -376,9 +441,18 @@ Buffer::AddAtEnd(uint32_t end)
     }
     else
     {
-        uint32_t newSize = GetInternalSize() + end;
+        if (isDirty)
+        {
+            g_stats.copies++;
+        }
+        else
+        {
+            g_stats.reallocations++;
+        }
+        // keep the headroom in front of the data, for the next headers
+        uint32_t newSize = g_headroom + GetInternalSize() + end;
         Buffer::Data* newData = Buffer::Create(newSize);
-        memcpy(newData->m_data, m_data->m_data + m_start, GetInternalSize());
+        memcpy(newData->m_data + g_headroom, m_data->m_data + m_start, GetInternalSize());
         m_data->m_count--;
         if (m_data->m_count == 0)
         {
@@ -386,7 +460,7 @@ Buffer::AddAtEnd(uint32_t end)
         }
         m_data = newData;
 
-        int32_t delta = -m_start;
+        int32_t delta = g_headroom - m_start;
         m_zeroAreaStart += delta;
         m_zeroAreaEnd += delta;
         m_end += delta;
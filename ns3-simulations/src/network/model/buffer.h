@@ -21,6 +21,7 @@
 
 #include "ns3/assert.h"
 
+#include <array>
 #include <ostream>
 #include <stdint.h>
 #include <vector>
@@ -39,9 +40,11 @@ namespace ns3
  * automatically adjusted to hold any data prepended
  * or appended by the user. Its implementation is optimized
  * to ensure that the number of buffer resizes is minimized,
- * by creating new Buffers of the maximum size ever used.
- * The correct maximum size is learned at runtime during use by
- * recording the maximum size of each packet.
+ * by reserving room for headers in front of new Buffers. The
+ * room is learned at runtime during use by recording the
+ * maximum size of the headers of each packet, and is at least
+ * the headroom set with SetHeadroom. The data storages are
+ * recycled in per-thread pools of power of two size classes.
  *
  * \internal
  * The implementation of the Buffer class uses a COW (Copy On Write)
@@ -650,6 +653,46 @@ class Buffer
     Buffer(uint32_t dataSize, bool initialize);
     ~Buffer();
 
+    /**
+     * \brief Counters of the buffer data storage operations.
+     *
+     * The counters are kept per thread, as the storage pools are.
+     */
+    struct Stats
+    {
+        uint64_t allocations;   //!< storages allocated from the heap
+        uint64_t recycled;      //!< storages reused from the pools
+        uint64_t reallocations; //!< data moved to a new storage, for lack of room
+        uint64_t copies;        //!< data copied to a new storage, as it was shared
+    };
+
+    /**
+     * \brief Get the counters of the calling thread.
+     * \returns the counters since the last reset
+     */
+    static Stats GetStats();
+    /**
+     * \brief Reset the counters of the calling thread.
+     */
+    static void ResetStats();
+    /**
+     * \brief Set the room reserved for headers in front of new buffers.
+     *
+     * New buffers start at the largest of the headroom and of the room
+     * the past buffers needed. A headroom large enough for the usual
+     * header stack avoids moving the first packets to larger storages
+     * when their headers are added. It must be set before the simulation
+     * runs.
+     *
+     * \param [in] headroom the headroom, in bytes
+     */
+    static void SetHeadroom(uint32_t headroom);
+    /**
+     * \brief Get the room reserved for headers in front of new buffers.
+     * \returns the headroom, in bytes
+     */
+    static uint32_t GetHeadroom();
+
   private:
     /**
      * This data structure is variable-sized through its last member whose size
@@ -734,6 +777,13 @@ class Buffer
      */
     uint32_t GetInternalEnd() const;
 
+    /**
+     * \brief Get the size class of a storage size
+     * \param size the storage size
+     * \returns the index of the smallest size class holding size bytes,
+     * or N_SIZE_CLASSES if it is larger than all of them
+     */
+    static uint32_t GetSizeClass(uint32_t size);
     /**
      * \brief Recycle the buffer memory
      * \param data the buffer data storage
@@ -775,7 +825,11 @@ class Buffer
      * writing data. i.e., m_start should be initialized to this
      * value.
      */
-    static uint32_t g_recommendedStart;
+    static thread_local uint32_t g_recommendedStart;
+    static uint32_t g_headroom;                 //!< room reserved for headers in new buffers
+    static thread_local Stats g_stats;          //!< counters of the storage operations
+    static const uint32_t MIN_CLASS_SIZE = 128; //!< storage size of the smallest size class
+    static const uint32_t N_SIZE_CLASSES = 10;  //!< number of size classes, doubling in size
 
     /**
      * offset to the start of the virtual zero area from the start
@@ -799,8 +853,8 @@ class Buffer
     uint32_t m_end;
 
 #ifdef BUFFER_FREE_LIST
-    /// Container for buffer data
-    typedef std::vector<Buffer::Data*> FreeList;
+    /// Container for buffer data, one list per size class
+    typedef std::array<std::vector<Buffer::Data*>, N_SIZE_CLASSES> FreeList;
 
     /// Local static destructor structure
     struct LocalStaticDestructor
@@ -808,9 +862,9 @@ class Buffer
         ~LocalStaticDestructor();
     };
 
-    static uint32_t g_maxSize;                            //!< Max observed data size
-    static FreeList* g_freeList;                          //!< Buffer data container
-    static LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
+    static thread_local FreeList* g_freeList; //!< Buffer data container
+    /// Local static destructor
+    static thread_local LocalStaticDestructor g_localStaticDestructor;
 #endif
 };
 
@@ -57,13 +57,20 @@ struct ByteTagListData
  *
  * Internal use only.
  */
-static class ByteTagListDataFreeList : public std::vector<ByteTagListData*>
+static thread_local class ByteTagListDataFreeList : public std::vector<ByteTagListData*>
 {
   public:
     ~ByteTagListDataFreeList();
-} g_freeList; //!< Container for struct ByteTagListData
+} g_freeList; //!< Container for struct ByteTagListData, per thread
 
-static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+static thread_local uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+
+/**
+ * The free list of the thread has been destroyed. The thread local objects
+ * of the main thread are destroyed before the static ones, which may still
+ * hold packets, so these are freed without the list.
+ */
+static thread_local bool g_freeListDestroyed = false;
 
 ByteTagListDataFreeList::~ByteTagListDataFreeList()
 {
@@ -73,6 +80,8 @@ ByteTagListDataFreeList::~ByteTagListDataFreeList()
         auto buffer = (uint8_t*)(*i);
         delete[] buffer;
     }
+    clear();
+    g_freeListDestroyed = true;
 }
 #endif /* USE_FREE_LIST */
 
@@ -356,7 +365,7 @@ ByteTagListData*
 ByteTagList::Allocate(uint32_t size)
 {
     NS_LOG_FUNCTION(this << size);
-    while (!g_freeList.empty())
+    while (!g_freeListDestroyed && !g_freeList.empty())
     {
         ByteTagListData* data = g_freeList.back();
         g_freeList.pop_back();
@@ -390,7 +399,7 @@ ByteTagList::Deallocate(ByteTagListData* data)
     data->count--;
     if (data->count == 0)
     {
-        if (g_freeList.size() > FREE_LIST_SIZE || data->size < g_maxSize)
+        if (g_freeListDestroyed || g_freeList.size() > FREE_LIST_SIZE || data->size < g_maxSize)
         {
             auto buffer = (uint8_t*)data;
             delete[] buffer;
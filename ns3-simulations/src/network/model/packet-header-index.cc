@@ -0,0 +1,189 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "packet-header-index.h"
+
+#include "ns3/log.h"
+
+#include <algorithm>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("PacketHeaderIndex");
+
+bool PacketHeaderIndex::m_enable = false;
+
+void
+PacketHeaderIndex::Enable()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    m_enable = true;
+}
+
+bool
+PacketHeaderIndex::IsEnabled()
+{
+    return m_enable;
+}
+
+PacketHeaderIndex::PacketHeaderIndex(uint32_t size)
+    : m_nHeaders(0),
+      m_valid(true),
+      m_payloadSize(size),
+      m_trailersSize(0)
+{
+}
+
+void
+PacketHeaderIndex::Invalidate()
+{
+    NS_LOG_FUNCTION(this);
+    m_valid = false;
+    m_nHeaders = 0;
+}
+
+void
+PacketHeaderIndex::AddHeader(uint16_t uid, uint32_t size)
+{
+    if (!m_valid)
+    {
+        return;
+    }
+    if (m_nHeaders == MAX_HEADERS || size > UINT16_MAX)
+    {
+        Invalidate();
+        return;
+    }
+    m_headers[m_nHeaders++] = {uid, static_cast<uint16_t>(size)};
+}
+
+void
+PacketHeaderIndex::RemoveHeader(uint16_t uid, uint32_t size)
+{
+    if (!m_valid)
+    {
+        return;
+    }
+    if (m_nHeaders == 0 || m_headers[m_nHeaders - 1].uid != uid ||
+        m_headers[m_nHeaders - 1].size != size)
+    {
+        Invalidate();
+        return;
+    }
+    m_nHeaders--;
+}
+
+void
+PacketHeaderIndex::AddTrailer(uint32_t size)
+{
+    m_trailersSize += size;
+}
+
+void
+PacketHeaderIndex::RemoveTrailer(uint32_t size)
+{
+    if (size > m_trailersSize)
+    {
+        Invalidate();
+        return;
+    }
+    m_trailersSize -= size;
+}
+
+void
+PacketHeaderIndex::AddAtEnd(const PacketHeaderIndex& o)
+{
+    if (!o.m_valid)
+    {
+        Invalidate();
+        return;
+    }
+    m_payloadSize += m_trailersSize + o.m_payloadSize;
+    for (uint8_t i = 0; i < o.m_nHeaders; i++)
+    {
+        m_payloadSize += o.m_headers[i].size;
+    }
+    m_trailersSize = o.m_trailersSize;
+}
+
+void
+PacketHeaderIndex::AddPaddingAtEnd(uint32_t size)
+{
+    if (m_trailersSize > 0)
+    {
+        m_trailersSize += size;
+    }
+    else
+    {
+        m_payloadSize += size;
+    }
+}
+
+void
+PacketHeaderIndex::RemoveAtStart(uint32_t size)
+{
+    while (size > 0 && m_nHeaders > 0)
+    {
+        if (size < m_headers[m_nHeaders - 1].size)
+        {
+            Invalidate();
+            return;
+        }
+        size -= m_headers[--m_nHeaders].size;
+    }
+    uint32_t payload = std::min(size, m_payloadSize);
+    m_payloadSize -= payload;
+    size -= payload;
+    m_trailersSize -= std::min(size, m_trailersSize);
+}
+
+void
+PacketHeaderIndex::RemoveAtEnd(uint32_t size)
+{
+    uint32_t trailers = std::min(size, m_trailersSize);
+    m_trailersSize -= trailers;
+    size -= trailers;
+    uint32_t payload = std::min(size, m_payloadSize);
+    m_payloadSize -= payload;
+    size -= payload;
+    if (size > 0 && m_nHeaders > 0)
+    {
+        Invalidate();
+    }
+}
+
+bool
+PacketHeaderIndex::Find(uint16_t uid, uint32_t& offset, uint32_t& size) const
+{
+    offset = 0;
+    for (uint8_t i = m_nHeaders; i > 0; i--)
+    {
+        if (m_headers[i - 1].uid == uid)
+        {
+            size = m_headers[i - 1].size;
+            return true;
+        }
+        offset += m_headers[i - 1].size;
+    }
+    return false;
+}
+
+uint32_t
+PacketHeaderIndex::GetPayloadSize() const
+{
+    return m_valid ? m_payloadSize : 0;
+}
+
+} // namespace ns3
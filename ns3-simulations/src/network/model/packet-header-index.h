@@ -0,0 +1,150 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef PACKET_HEADER_INDEX_H
+#define PACKET_HEADER_INDEX_H
+
+#include <array>
+#include <stdint.h>
+
+namespace ns3
+{
+
+/**
+ * \ingroup packet
+ *
+ * \brief Index of the headers at the start of a packet.
+ *
+ * A lightweight alternative to the PacketMetadata, to find the headers of
+ * a packet without enabling the printing of all of the packets. The index
+ * records the type and the size of the last headers added to the packet,
+ * in a fixed size array, and the sizes of the payload and of the trailers.
+ * The headers inside the payload (e.g., those of a packet appended to
+ * another one) are not indexed.
+ *
+ * The index is lost, and the lookups fail, when the packet goes through
+ * an operation it cannot follow: more headers than it holds, removal of a
+ * header which is not the last one added, or of a part of a header.
+ *
+ * Like the PacketMetadata, it is disabled by default, and must be enabled
+ * before any packet is created.
+ */
+class PacketHeaderIndex
+{
+  public:
+    /**
+     * \brief Enable the header index of the packets.
+     */
+    static void Enable();
+
+    /**
+     * \brief Check whether the header index of the packets is enabled.
+     * \return true if the header index is enabled
+     */
+    static bool IsEnabled();
+
+    /**
+     * \brief Constructor
+     * \param [in] size the payload size of the packet
+     */
+    PacketHeaderIndex(uint32_t size);
+
+    /**
+     * \brief Record a header added at the start of the packet.
+     * \param [in] uid the TypeId uid of the header
+     * \param [in] size the header size
+     */
+    void AddHeader(uint16_t uid, uint32_t size);
+    /**
+     * \brief Record a header removed from the start of the packet.
+     * \param [in] uid the TypeId uid of the header
+     * \param [in] size the header size
+     */
+    void RemoveHeader(uint16_t uid, uint32_t size);
+    /**
+     * \brief Record a trailer added at the end of the packet.
+     * \param [in] size the trailer size
+     */
+    void AddTrailer(uint32_t size);
+    /**
+     * \brief Record a trailer removed from the end of the packet.
+     * \param [in] size the trailer size
+     */
+    void RemoveTrailer(uint32_t size);
+    /**
+     * \brief Record a packet appended to the packet.
+     *
+     * Its headers and payload, and the trailers of the packet, become
+     * part of the payload.
+     *
+     * \param [in] o the index of the appended packet
+     */
+    void AddAtEnd(const PacketHeaderIndex& o);
+    /**
+     * \brief Record padding added at the end of the packet.
+     * \param [in] size the padding size
+     */
+    void AddPaddingAtEnd(uint32_t size);
+    /**
+     * \brief Record bytes removed from the start of the packet.
+     * \param [in] size the number of bytes
+     */
+    void RemoveAtStart(uint32_t size);
+    /**
+     * \brief Record bytes removed from the end of the packet.
+     * \param [in] size the number of bytes
+     */
+    void RemoveAtEnd(uint32_t size);
+
+    /**
+     * \brief Find a header.
+     * \param [in] uid the TypeId uid of the header
+     * \param [out] offset the offset of the header from the start of the packet
+     * \param [out] size the header size
+     * \return true if the header was found
+     */
+    bool Find(uint16_t uid, uint32_t& offset, uint32_t& size) const;
+
+    /**
+     * \brief Get the payload size.
+     * \return the payload size, or 0 if the index was lost
+     */
+    uint32_t GetPayloadSize() const;
+
+  private:
+    /// The number of headers an index holds
+    static const uint32_t MAX_HEADERS = 4;
+
+    /// An indexed header
+    struct Item
+    {
+        uint16_t uid;  //!< TypeId uid of the header
+        uint16_t size; //!< header size
+    };
+
+    /// Lose the index.
+    void Invalidate();
+
+    static bool m_enable; //!< Enable the header index
+
+    std::array<Item, MAX_HEADERS> m_headers; //!< Headers, from the innermost one
+    uint8_t m_nHeaders;                      //!< Number of headers
+    bool m_valid;                            //!< Whether the index follows the packet
+    uint32_t m_payloadSize;                  //!< Payload size
+    uint32_t m_trailersSize;                 //!< Size of the trailers
+};
+
+} // namespace ns3
+
+#endif /* PACKET_HEADER_INDEX_H */
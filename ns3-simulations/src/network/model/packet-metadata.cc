@@ -27,6 +27,7 @@
 #include "ns3/log.h"
 
 #include <list>
+#include <thread>
 #include <utility>
 
 namespace ns3
@@ -37,9 +38,12 @@ NS_LOG_COMPONENT_DEFINE("PacketMetadata");
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
 bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
-uint16_t PacketMetadata::m_chunkUid = 0;
-PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+thread_local uint32_t PacketMetadata::m_maxSize = 0;
+thread_local uint16_t PacketMetadata::m_chunkUid = 0;
+thread_local PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+
+/** The thread running the static initialization, i.e. the main thread. */
+static const std::thread::id g_mainThreadId = std::this_thread::get_id();
 
 PacketMetadata::DataFreeList::~DataFreeList()
 {
@@ -48,7 +52,12 @@ PacketMetadata::DataFreeList::~DataFreeList()
     {
         PacketMetadata::Deallocate(*i);
     }
-    PacketMetadata::m_enable = false;
+    // only the end of the program, not the end of a simulation thread,
+    // disables the metadata
+    if (std::this_thread::get_id() == g_mainThreadId)
+    {
+        PacketMetadata::m_enable = false;
+    }
 }
 
 void
@@ -30,7 +30,7 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("Packet");
 
-uint32_t Packet::m_globalUid = 0;
+thread_local uint32_t Packet::m_globalUid = 0;
 
 TypeId
 ByteTagIterator::Item::GetTypeId() const
@@ -147,6 +147,7 @@ Packet::Packet()
        * global UID
        */
       m_metadata(static_cast<uint64_t>(Simulator::GetSystemId()) << 32 | m_globalUid, 0),
+      m_headerIndex(0),
       m_nixVector(nullptr)
 {
     m_globalUid++;
@@ -156,7 +157,8 @@ Packet::Packet(const Packet& o)
     : m_buffer(o.m_buffer),
       m_byteTagList(o.m_byteTagList),
       m_packetTagList(o.m_packetTagList),
-      m_metadata(o.m_metadata)
+      m_metadata(o.m_metadata),
+      m_headerIndex(o.m_headerIndex)
 {
     o.m_nixVector ? m_nixVector = o.m_nixVector->Copy() : m_nixVector = nullptr;
 }
@@ -172,6 +174,7 @@ Packet::operator=(const Packet& o)
     m_byteTagList = o.m_byteTagList;
     m_packetTagList = o.m_packetTagList;
     m_metadata = o.m_metadata;
+    m_headerIndex = o.m_headerIndex;
     o.m_nixVector ? m_nixVector = o.m_nixVector->Copy() : m_nixVector = nullptr;
     return *this;
 }
@@ -187,6 +190,7 @@ Packet::Packet(uint32_t size)
        * global UID
        */
       m_metadata(static_cast<uint64_t>(Simulator::GetSystemId()) << 32 | m_globalUid, size),
+      m_headerIndex(size),
       m_nixVector(nullptr)
 {
     m_globalUid++;
@@ -197,10 +201,12 @@ Packet::Packet(const uint8_t* buffer, uint32_t size, bool magic)
       m_byteTagList(),
       m_packetTagList(),
       m_metadata(0, 0),
+      m_headerIndex(0),
       m_nixVector(nullptr)
 {
     NS_ASSERT(magic);
     Deserialize(buffer, size);
+    m_headerIndex = PacketHeaderIndex(GetSize());
 }
 
 Packet::Packet(const uint8_t* buffer, uint32_t size)
@@ -214,6 +220,7 @@ Packet::Packet(const uint8_t* buffer, uint32_t size)
        * global UID
        */
       m_metadata(static_cast<uint64_t>(Simulator::GetSystemId()) << 32 | m_globalUid, size),
+      m_headerIndex(size),
       m_nixVector(nullptr)
 {
     m_globalUid++;
@@ -225,11 +232,13 @@ Packet::Packet(const uint8_t* buffer, uint32_t size)
 Packet::Packet(const Buffer& buffer,
                const ByteTagList& byteTagList,
                const PacketTagList& packetTagList,
-               const PacketMetadata& metadata)
+               const PacketMetadata& metadata,
+               const PacketHeaderIndex& headerIndex)
     : m_buffer(buffer),
       m_byteTagList(byteTagList),
       m_packetTagList(packetTagList),
       m_metadata(metadata),
+      m_headerIndex(headerIndex),
       m_nixVector(nullptr)
 {
 }
@@ -244,10 +253,16 @@ Packet::CreateFragment(uint32_t start, uint32_t length) const
     NS_ASSERT(m_buffer.GetSize() >= start + length);
     uint32_t end = m_buffer.GetSize() - (start + length);
     PacketMetadata metadata = m_metadata.CreateFragment(start, end);
+    PacketHeaderIndex headerIndex = m_headerIndex;
+    if (PacketHeaderIndex::IsEnabled())
+    {
+        headerIndex.RemoveAtStart(start);
+        headerIndex.RemoveAtEnd(end);
+    }
     // again, call the constructor directly rather than
     // through Create because it is private.
     Ptr<Packet> ret =
-        Ptr<Packet>(new Packet(buffer, byteTagList, m_packetTagList, metadata), false);
+        Ptr<Packet>(new Packet(buffer, byteTagList, m_packetTagList, metadata, headerIndex), false);
     ret->SetNixVector(GetNixVector());
     return ret;
 }
@@ -274,6 +289,10 @@ Packet::AddHeader(const Header& header)
     m_byteTagList.AddAtStart(size);
     header.Serialize(m_buffer.Begin());
     m_metadata.AddHeader(header, size);
+    if (PacketHeaderIndex::IsEnabled())
+    {
+        m_headerIndex.AddHeader(header.GetInstanceTypeId().GetUid(), size);
+    }
 }
 
 uint32_t
@@ -287,6 +306,10 @@ Packet::RemoveHeader(Header& header, uint32_t size)
     m_buffer.RemoveAtStart(deserialized);
     m_byteTagList.Adjust(-deserialized);
     m_metadata.RemoveHeader(header, deserialized);
+    if (PacketHeaderIndex::IsEnabled())
+    {
+        m_headerIndex.RemoveHeader(header.GetInstanceTypeId().GetUid(), deserialized);
+    }
     return deserialized;
 }
 
@@ -298,6 +321,10 @@ Packet::RemoveHeader(Header& header)
     m_buffer.RemoveAtStart(deserialized);
     m_byteTagList.Adjust(-deserialized);
     m_metadata.RemoveHeader(header, deserialized);
+    if (PacketHeaderIndex::IsEnabled())
+    {
+        m_headerIndex.RemoveHeader(header.GetInstanceTypeId().GetUid(), deserialized);
+    }
     return deserialized;
 }
 
@@ -330,6 +357,7 @@ Packet::AddTrailer(const Trailer& trailer)
     Buffer::Iterator end = m_buffer.End();
     trailer.Serialize(end);
     m_metadata.AddTrailer(trailer, size);
+    m_headerIndex.AddTrailer(size);
 }
 
 uint32_t
@@ -339,6 +367,7 @@ Packet::RemoveTrailer(Trailer& trailer)
     NS_LOG_FUNCTION(this << trailer.GetInstanceTypeId().GetName() << deserialized);
     m_buffer.RemoveAtEnd(deserialized);
     m_metadata.RemoveTrailer(trailer, deserialized);
+    m_headerIndex.RemoveTrailer(deserialized);
     return deserialized;
 }
 
@@ -361,6 +390,7 @@ Packet::AddAtEnd(Ptr<const Packet> packet)
     m_byteTagList.Add(copy);
     m_buffer.AddAtEnd(packet->m_buffer);
     m_metadata.AddAtEnd(packet->m_metadata);
+    m_headerIndex.AddAtEnd(packet->m_headerIndex);
 }
 
 void
@@ -370,6 +400,7 @@ Packet::AddPaddingAtEnd(uint32_t size)
     m_byteTagList.AddAtEnd(GetSize());
     m_buffer.AddAtEnd(size);
     m_metadata.AddPaddingAtEnd(size);
+    m_headerIndex.AddPaddingAtEnd(size);
 }
 
 void
@@ -378,6 +409,7 @@ Packet::RemoveAtEnd(uint32_t size)
     NS_LOG_FUNCTION(this << size);
     m_buffer.RemoveAtEnd(size);
     m_metadata.RemoveAtEnd(size);
+    m_headerIndex.RemoveAtEnd(size);
 }
 
 void
@@ -387,6 +419,7 @@ Packet::RemoveAtStart(uint32_t size)
     m_buffer.RemoveAtStart(size);
     m_byteTagList.Adjust(-size);
     m_metadata.RemoveAtStart(size);
+    m_headerIndex.RemoveAtStart(size);
 }
 
 void
@@ -457,6 +490,10 @@ Packet::ToString() const
 uint32_t
 Packet::GetPayloadSize() const
 {
+    if (PacketHeaderIndex::IsEnabled())
+    {
+        return m_headerIndex.GetPayloadSize();
+    }
     PacketMetadata::ItemIterator i = m_metadata.BeginItem(m_buffer);
     while (i.HasNext())
     {
@@ -469,60 +506,65 @@ Packet::GetPayloadSize() const
     return 0;
 }
 
-Chunk*
-Packet::extractTcpHeader() const
+uint32_t
+Packet::FindHeader(Header& header) const
 {
+    TypeId tid = header.GetInstanceTypeId();
+    if (PacketHeaderIndex::IsEnabled())
+    {
+        uint32_t offset;
+        uint32_t size;
+        if (!m_headerIndex.Find(tid.GetUid(), offset, size))
+        {
+            return 0;
+        }
+        Buffer::Iterator start = m_buffer.Begin();
+        start.Next(offset);
+        Buffer::Iterator end = start;
+        end.Next(size);
+        return header.Deserialize(start, end);
+    }
     PacketMetadata::ItemIterator i = m_metadata.BeginItem(m_buffer);
     while (i.HasNext())
     {
         PacketMetadata::Item item = i.Next();
-        if (item.type == PacketMetadata::Item::HEADER)
+        if (item.type == PacketMetadata::Item::HEADER && !item.isFragment && item.tid == tid)
         {
-            if (item.tid.GetName() == "ns3::TcpHeader")
-            {
-                NS_ASSERT(item.tid.HasConstructor());
-                Callback<ObjectBase*> constructor = item.tid.GetConstructor();
-                NS_ASSERT(!constructor.IsNull());
-                ObjectBase* instance = constructor();
-                NS_ASSERT(instance != 0);
-                Chunk* chunk = dynamic_cast<Chunk*>(instance);
-                NS_ASSERT(chunk != 0);
-                Buffer::Iterator end = item.current;
-                end.Next(item.currentSize); // move from start
-                chunk->Deserialize(item.current, end);
-                return chunk;
-            }
+            Buffer::Iterator end = item.current;
+            end.Next(item.currentSize); // move from start
+            return header.Deserialize(item.current, end);
         }
     }
-    return NULL;
+    return 0;
 }
 
 Chunk*
-Packet::extractIPv4Header() const
-{
-    PacketMetadata::ItemIterator i = m_metadata.BeginItem(m_buffer);
-    while (i.HasNext())
+Packet::ExtractHeader(const std::string& name) const
+{
+    TypeId tid = TypeId::LookupByName(name);
+    NS_ASSERT(tid.HasConstructor());
+    Callback<ObjectBase*> constructor = tid.GetConstructor();
+    NS_ASSERT(!constructor.IsNull());
+    auto header = dynamic_cast<Header*>(constructor());
+    NS_ASSERT(header != nullptr);
+    if (FindHeader(*header) == 0)
     {
-        PacketMetadata::Item item = i.Next();
-        if (item.type == PacketMetadata::Item::HEADER)
-        {
-            if (item.tid.GetName() == "ns3::Ipv4Header")
-            {
-                NS_ASSERT(item.tid.HasConstructor());
-                Callback<ObjectBase*> constructor = item.tid.GetConstructor();
-                NS_ASSERT(!constructor.IsNull());
-                ObjectBase* instance = constructor();
-                NS_ASSERT(instance != 0);
-                Chunk* chunk = dynamic_cast<Chunk*>(instance);
-                NS_ASSERT(chunk != 0);
-                Buffer::Iterator end = item.current;
-                end.Next(item.currentSize); // move from start
-                chunk->Deserialize(item.current, end);
-                return chunk;
-            }
-        }
+        delete header;
+        return nullptr;
     }
-    return NULL;
+    return header;
+}
+
+Chunk*
+Packet::extractTcpHeader() const
+{
+    return ExtractHeader("ns3::TcpHeader");
+}
+
+Chunk*
+Packet::extractIPv4Header() const
+{
+    return ExtractHeader("ns3::Ipv4Header");
 }
 
 /* End of Penny artifact evaluation changes */
@@ -674,6 +716,13 @@ Packet::EnablePrinting()
     PacketMetadata::Enable();
 }
 
+void
+Packet::EnableHeaderIndex()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    PacketHeaderIndex::Enable();
+}
+
 void
 Packet::EnableChecking()
 {
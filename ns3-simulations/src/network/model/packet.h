@@ -23,6 +23,7 @@
 #include "byte-tag-list.h"
 #include "header.h"
 #include "nix-vector.h"
+#include "packet-header-index.h"
 #include "packet-metadata.h"
 #include "packet-tag-list.h"
 #include "tag.h"
@@ -34,6 +35,7 @@
 #include "ns3/ptr.h"
 
 #include <stdint.h>
+#include <string>
 
 namespace ns3
 {
@@ -503,6 +505,20 @@ class Packet : public SimpleRefCount<Packet>
 
     uint32_t GetPayloadSize() const;
 
+    /**
+     * \brief Deserialize a header found anywhere in the packet, without
+     * removing it.
+     *
+     * The header is found with the header index if it is enabled, or with
+     * the packet metadata otherwise, which requires EnablePrinting.
+     *
+     * \param [in,out] header the header to find and deserialize
+     * \returns the size of the header, or 0 if it was not found
+     *
+     * \sa EnableHeaderIndex EnablePrinting
+     */
+    uint32_t FindHeader(Header& header) const;
+
     /* End of Penny artifact evaluation changes */
 
     /**
@@ -538,6 +554,18 @@ class Packet : public SimpleRefCount<Packet>
      * simulation setup and before any packet is created.
      */
     static void EnablePrinting();
+    /**
+     * \brief Enable the header index of the packets.
+     *
+     * A lightweight alternative to EnablePrinting, for FindHeader and
+     * GetPayloadSize only: each packet keeps the types and sizes of its
+     * last headers instead of its full metadata. You need to invoke this
+     * method at least once during the simulation setup and before any
+     * packet is created.
+     *
+     * \sa PacketHeaderIndex
+     */
+    static void EnableHeaderIndex();
     /**
      * \brief Enable packets metadata checking.
      *
@@ -788,11 +816,21 @@ class Packet : public SimpleRefCount<Packet>
      * \param byteTagList the ByteTag list
      * \param packetTagList the packet's Tag list
      * \param metadata the packet's metadata
+     * \param headerIndex the packet's header index
      */
     Packet(const Buffer& buffer,
            const ByteTagList& byteTagList,
            const PacketTagList& packetTagList,
-           const PacketMetadata& metadata);
+           const PacketMetadata& metadata,
+           const PacketHeaderIndex& headerIndex);
+
+    /**
+     * \brief Create and deserialize a header found in the packet.
+     * \param [in] name the TypeId name of the header
+     * \returns the header, to be deleted by the caller, or nullptr if it
+     * was not found
+     */
+    Chunk* ExtractHeader(const std::string& name) const;
 
     /**
      * \brief Deserializes a packet.
@@ -802,15 +840,21 @@ class Packet : public SimpleRefCount<Packet>
      */
     uint32_t Deserialize(const uint8_t* buffer, uint32_t size);
 
-    Buffer m_buffer;               //!< the packet buffer (it's actual contents)
-    ByteTagList m_byteTagList;     //!< the ByteTag list
-    PacketTagList m_packetTagList; //!< the packet's Tag list
-    PacketMetadata m_metadata;     //!< the packet's metadata
+    Buffer m_buffer;                 //!< the packet buffer (it's actual contents)
+    ByteTagList m_byteTagList;       //!< the ByteTag list
+    PacketTagList m_packetTagList;   //!< the packet's Tag list
+    PacketMetadata m_metadata;       //!< the packet's metadata
+    PacketHeaderIndex m_headerIndex; //!< the packet's header index
 
     /* Please see comments above about nix-vector */
     mutable Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
-    static uint32_t m_globalUid; //!< Global counter of packets Uid
+    /**
+     * Counter of packets Uid. It is per thread, and the uids are unique
+     * as they also hold the system id, which is per thread with the
+     * multithreaded simulator.
+     */
+    static thread_local uint32_t m_globalUid;
 };
 
 /**
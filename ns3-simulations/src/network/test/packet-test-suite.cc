@@ -1265,6 +1265,89 @@ PacketTagListTest::DoRun()
 } // Timing
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Packet header index Test
+ */
+class PacketHeaderIndexTest : public TestCase
+{
+  public:
+    PacketHeaderIndexTest();
+
+  private:
+    void DoRun() override;
+};
+
+PacketHeaderIndexTest::PacketHeaderIndexTest()
+    : TestCase("Packet header index")
+{
+}
+
+void
+PacketHeaderIndexTest::DoRun()
+{
+    uint32_t offset = 0;
+    uint32_t size = 0;
+
+    PacketHeaderIndex index(100);
+    index.AddHeader(1, 20);
+    index.AddHeader(2, 8);
+    index.AddTrailer(4);
+    NS_TEST_EXPECT_MSG_EQ(index.Find(1, offset, size), true, "Inner header not found");
+    NS_TEST_EXPECT_MSG_EQ(offset, 8, "Wrong inner header offset");
+    NS_TEST_EXPECT_MSG_EQ(size, 20, "Wrong inner header size");
+    NS_TEST_EXPECT_MSG_EQ(index.Find(2, offset, size), true, "Outer header not found");
+    NS_TEST_EXPECT_MSG_EQ(offset, 0, "Wrong outer header offset");
+    NS_TEST_EXPECT_MSG_EQ(index.Find(3, offset, size), false, "Unexpected header found");
+    NS_TEST_EXPECT_MSG_EQ(index.GetPayloadSize(), 100, "Wrong payload size");
+
+    // fragments keep the headers they start with
+    PacketHeaderIndex fragment = index;
+    fragment.RemoveAtStart(8);
+    fragment.RemoveAtEnd(54);
+    NS_TEST_EXPECT_MSG_EQ(fragment.Find(1, offset, size), true, "Header lost by a fragment");
+    NS_TEST_EXPECT_MSG_EQ(offset, 0, "Wrong header offset in a fragment");
+    NS_TEST_EXPECT_MSG_EQ(fragment.GetPayloadSize(), 50, "Wrong fragment payload size");
+
+    // the headers and trailers around an appended packet become payload
+    PacketHeaderIndex appended(10);
+    appended.AddHeader(3, 4);
+    index.AddAtEnd(appended);
+    NS_TEST_EXPECT_MSG_EQ(index.Find(3, offset, size), false, "Appended header indexed");
+    NS_TEST_EXPECT_MSG_EQ(index.GetPayloadSize(), 118, "Wrong payload size after append");
+
+    // the index is lost when it cannot follow the packet
+    index.RemoveAtStart(10);
+    NS_TEST_EXPECT_MSG_EQ(index.Find(1, offset, size), false, "Header found in a lost index");
+    NS_TEST_EXPECT_MSG_EQ(index.GetPayloadSize(), 0, "Payload size of a lost index");
+    PacketHeaderIndex full(0);
+    for (uint16_t i = 0; i < 5; i++)
+    {
+        full.AddHeader(i, 1);
+    }
+    NS_TEST_EXPECT_MSG_EQ(full.Find(4, offset, size), false, "Header found in a full index");
+
+    // through the packets
+    Packet::EnableHeaderIndex();
+    Ptr<Packet> packet = Create<Packet>(1000);
+    packet->AddHeader(ATestHeader<10>());
+    packet->AddHeader(ATestHeader<2>());
+    packet->AddTrailer(ATestTrailer<3>());
+    Ptr<Packet> copy = packet->Copy();
+    ATestHeader<2> outer;
+    copy->RemoveHeader(outer);
+    ATestHeader<10> header;
+    NS_TEST_EXPECT_MSG_EQ(copy->FindHeader(header), 10, "Header not found");
+    NS_TEST_EXPECT_MSG_EQ(header.m_error, false, "Header wrongly deserialized");
+    NS_TEST_EXPECT_MSG_EQ(copy->FindHeader(outer), 0, "Removed header found");
+    NS_TEST_EXPECT_MSG_EQ(copy->GetPayloadSize(), 1000, "Wrong packet payload size");
+    ATestHeader<10> original;
+    NS_TEST_EXPECT_MSG_EQ(packet->FindHeader(original), 10, "Header of the original not found");
+    NS_TEST_EXPECT_MSG_EQ(original.m_error, false, "Header of the original wrongly deserialized");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -1282,6 +1365,7 @@ PacketTestSuite::PacketTestSuite()
 {
     AddTestCase(new PacketTest, TestCase::QUICK);
     AddTestCase(new PacketTagListTest, TestCase::QUICK);
+    AddTestCase(new PacketHeaderIndexTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite; //!< Static variable for test initialization
@@ -20,10 +20,13 @@
 #include "point-to-point-net-device.h"
 
 #include "ns3/log.h"
+#include "ns3/node.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/trace-source-accessor.h"
 
+#include <vector>
+
 namespace ns3
 {
 
@@ -82,6 +85,29 @@ PointToPointChannel::Attach(Ptr<PointToPointNetDevice> device)
         m_link[1].m_dst = m_link[0].m_src;
         m_link[0].m_state = IDLE;
         m_link[1].m_state = IDLE;
+        CacheNodeIds();
+    }
+}
+
+void
+PointToPointChannel::CacheNodeIds()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_nDevices < N_DEVICES)
+    {
+        return;
+    }
+    for (auto& link : m_link)
+    {
+        Ptr<Node> src = link.m_src->GetNode();
+        Ptr<Node> dst = link.m_dst->GetNode();
+        if (src && dst)
+        {
+            link.m_dstNodeId = dst->GetId();
+            link.m_srcSystemId = src->GetSystemId();
+            link.m_dstSystemId = dst->GetSystemId();
+            link.m_nodeIdsKnown = true;
+        }
     }
 }
 
@@ -96,14 +122,36 @@ PointToPointChannel::TransmitStart(Ptr<const Packet> p, Ptr<PointToPointNetDevic
 
     uint32_t wire = src == m_link[0].m_src ? 0 : 1;
 
-    Simulator::ScheduleWithContext(m_link[wire].m_dst->GetNode()->GetId(),
+    Link& link = m_link[wire];
+    if (!link.m_nodeIdsKnown)
+    {
+        CacheNodeIds();
+    }
+
+    if (link.m_dstSystemId != link.m_srcSystemId)
+    {
+        // With the multithreaded simulator, the receiver runs on another
+        // thread: give it a deep copy of the packet, which shares no
+        // reference counted data with the sender, and do not touch the
+        // reference counts of the receiving device and node either
+        std::vector<uint8_t> buffer(p->GetSerializedSize());
+        p->Serialize(buffer.data(), buffer.size());
+        Simulator::ScheduleWithContext(link.m_dstNodeId,
+                                       txTime + m_delay,
+                                       &PointToPointNetDevice::Receive,
+                                       PeekPointer(link.m_dst),
+                                       Create<Packet>(buffer.data(), buffer.size(), true));
+        return true;
+    }
+
+    Simulator::ScheduleWithContext(link.m_dstNodeId,
                                    txTime + m_delay,
                                    &PointToPointNetDevice::Receive,
-                                   m_link[wire].m_dst,
+                                   link.m_dst,
                                    p->Copy());
 
     // Call the tx anim callback on the net device
-    m_txrxPointToPoint(p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
+    m_txrxPointToPoint(p, src, link.m_dst, txTime, txTime + m_delay);
     return true;
 }
 
@@ -72,6 +72,17 @@ class PointToPointChannel : public Channel
      */
     void Attach(Ptr<PointToPointNetDevice> device);
 
+    /**
+     * \brief Record the ids and system ids of the nodes of both devices
+     *
+     * TransmitStart uses the recorded ids, so that it does not take a
+     * reference to the receiving node, which may run on another thread
+     * with the MultithreadedSimulatorImpl. Called by Attach, and before
+     * the simulation starts for the devices added to their nodes after
+     * being attached.
+     */
+    void CacheNodeIds();
+
     /**
      * \brief Transmit a packet over this channel
      * \param p Packet to transmit
@@ -161,6 +172,9 @@ class PointToPointChannel : public Channel
      * net device, receiving net device, transmission time and
      * packet receipt time.
      *
+     * Not fired for the packets sent to a node of another system id,
+     * as the receiving device may be in use by another thread.
+     *
      * \see class CallBackTraceSource
      * \deprecated The non-const \c Ptr<NetDevice> argument is deprecated
      * and will be changed to \c Ptr<const NetDevice> in a future release.
@@ -200,13 +214,21 @@ class PointToPointChannel : public Channel
         Link()
             : m_state(INITIALIZING),
               m_src(nullptr),
-              m_dst(nullptr)
+              m_dst(nullptr),
+              m_nodeIdsKnown(false),
+              m_dstNodeId(0),
+              m_srcSystemId(0),
+              m_dstSystemId(0)
         {
         }
 
         WireState m_state;                //!< State of the link
         Ptr<PointToPointNetDevice> m_src; //!< First NetDevice
         Ptr<PointToPointNetDevice> m_dst; //!< Second NetDevice
+        bool m_nodeIdsKnown;              //!< The node ids below are set
+        uint32_t m_dstNodeId;             //!< Id of the node of the second NetDevice
+        uint32_t m_srcSystemId;           //!< System id of the node of the first NetDevice
+        uint32_t m_dstSystemId;           //!< System id of the node of the second NetDevice
     };
 
     Link m_link[N_DEVICES]; //!< Link model
@@ -354,8 +354,9 @@ PointToPointNetDevice::TransmitStart(Ptr<Packet> p)
     if (is_random_loss_enabled)
     {
         bool backgroundTraffic = false;
-        TcpHeader* pkt = (TcpHeader*)p->extractTcpHeader();
-        if(IsPortInRange(pkt->GetSourcePort(), 20000, 21000) || IsPortInRange(pkt->GetDestinationPort(), 20000, 21000))
+        TcpHeader pkt;
+        p->FindHeader(pkt);
+        if(IsPortInRange(pkt.GetSourcePort(), 20000, 21000) || IsPortInRange(pkt.GetDestinationPort(), 20000, 21000))
         {
             backgroundTraffic = true;
         }
@@ -461,6 +461,7 @@ main(int argc, char* argv[])
     bool schedList = false;
     bool schedMap = false; // default scheduler
     bool schedPQ = false;
+    bool schedQuad = false;
 
     uint64_t pop = 100000;
     uint64_t total = 1000000;
@@ -476,7 +477,9 @@ main(int argc, char* argv[])
               "  an ascii file, given by the --file=\"<filename>\" argument,\n"
               "  or standard input, by the argument --file=\"-\"\n"
               "In the case of either --file form, the input is expected\n"
-              "to be ascii, giving the relative event times in ns.\n"
+              "to be ascii, giving the relative event times in seconds.\n"
+              "Such a file is recorded from a Penny simulation with\n"
+              "  ./ns3 run \"scratch/penny/sim.cc ... --argEventTrace=<filename>\"\n"
               "\n"
               "If no scheduler is specified the MapScheduler will be run.");
     cmd.AddValue("all", "use all schedulers", allSched);
@@ -486,6 +489,7 @@ main(int argc, char* argv[])
     cmd.AddValue("list", "use ListSheduler", schedList);
     cmd.AddValue("map", "use MapScheduler (default)", schedMap);
     cmd.AddValue("pri", "use PriorityQueue", schedPQ);
+    cmd.AddValue("quad", "use QuadHeapScheduler", schedQuad);
     cmd.AddValue("debug", "enable debugging output", g_debug);
     cmd.AddValue("pop", "event population size", pop);
     cmd.AddValue("total", "total number of events to run", total);
@@ -506,10 +510,10 @@ main(int argc, char* argv[])
 
     if (allSched)
     {
-        schedCal = schedHeap = schedList = schedMap = schedPQ = true;
+        schedCal = schedHeap = schedList = schedMap = schedPQ = schedQuad = true;
     }
     // Set the default case if nothing else is set
-    if (!(schedCal || schedHeap || schedList || schedMap || schedPQ))
+    if (!(schedCal || schedHeap || schedList || schedMap || schedPQ || schedQuad))
     {
         schedMap = true;
     }
@@ -554,6 +558,11 @@ main(int argc, char* argv[])
         factory.SetTypeId("ns3::PriorityQueueScheduler");
         BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
     }
+    if (schedQuad)
+    {
+        factory.SetTypeId("ns3::QuadHeapScheduler");
+        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+    }
 
     return 0;
 }
@@ -1,25 +1,39 @@
 #!/bin/bash
 
+# Usage: bash run.sh [montecarlo|exact]
+# "montecarlo" (default) samples the drop process, "exact" computes the
+# same table from the binomial distributions without sampling noise.
+mode=${1:-montecarlo}
+case "$mode" in
+  montecarlo) simulator_args="" ;;
+  exact) simulator_args="--exact" ;;
+  *)
+    echo "Usage: $0 [montecarlo|exact]"
+    exit 1
+    ;;
+esac
+
 # Check if tempFiles/results.txt exists
 if [ -f tempFiles/results.txt ]; then
   echo "File 'tempFiles/results.txt' already exists. Skipping simulator execution."
 else
   # Execute simulator if tempFiles/results.txt does not exist
   echo "Compiling the simulator..."
-  g++ -O2 -o simulator sim.cc -lm
+  g++ -O2 -pthread -o simulator sim.cc simd.cc -lm
 
   echo "Creating tempFiles directory..."
   mkdir -p tempFiles
 
-  echo "Running the simulator..."
-  ./simulator > tempFiles/results.txt
+  # the simulator writes the per-d files for gnuplot itself
+  echo "Running the simulator ($mode)..."
+  ./simulator $simulator_args --split tempFiles > tempFiles/results.txt
 fi
 
-# Continue with data extraction and plotting
-echo "Extracting data from results.txt..."
-for i in {2..45}; do
-  grep "d $i " tempFiles/results.txt > tempFiles/"d$i"
-done
+# Results from an earlier run may come without the per-d files
+if [ ! -f tempFiles/d2 ]; then
+  echo "Extracting data from results.txt..."
+  awk '{ print > ("tempFiles/d" $4) }' tempFiles/results.txt
+fi
 
 echo "Generating plots with gnuplot..."
 gnuplot -persist plot.gp
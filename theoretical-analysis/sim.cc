@@ -1,108 +1,541 @@
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <math.h>
+#include <getopt.h>
 #include <random>
+#include <string>
+#include <vector>
 #include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <errno.h>
+#include <sys/stat.h>
 
-#define MAX_N 400
-
-// beware - there's a truncation effect that happens just before
-// MAX_DUPS, so set MAX_DUPS to be greater than the maximum duplicates
-// that you care about evaluating.
-#define MAX_DUPS 50
-
-#define MAX_DUP_THRESH 0.15 
-#define DROP_FRAC 0.05
-#define PROB_LEGIT_SRC 0.95
-#define H1_H2_RATIO 0.01
+#include "sim.h"
 
 double rnd() {
     double r = random() / double(RAND_MAX);
     return r;
 }
 
-int main() {
-    // two dimensional arrays to hold the results for different
-    // combinations of N and D (where D is number of dups sent by the malicious user)
-    int undecided[MAX_N][MAX_DUPS];
-    int bidir[MAX_N][MAX_DUPS];
-    int non_bidir[MAX_N][MAX_DUPS];
-    int max_dups[MAX_N][MAX_DUPS];
-    int totalresults[MAX_N][MAX_DUPS];
-
-    for (int n = 0; n < MAX_N; n++) {
-        for (int dups = 0; dups < MAX_DUPS; dups++) {
-            undecided[n][dups] = 0;
-            bidir[n][dups] = 0;
-            non_bidir[n][dups] = 0;
-            max_dups[n][dups] = 0;
-            totalresults[n][dups] = 0;
-        }
-    }
-
-    for (int run = 0; run < 1000000; run++) {
-        for (int dups = 2; dups < MAX_DUPS; dups++) {
-            int dupcount = 0;  // as seen at monitor
-            int origdupcount = 0; // as sent by attacker
-            int dropcount = 0;
-            int correctcount = 0;
-            for (int n = 1; n < MAX_N; n++) {
-                bool dropped = rnd() <= DROP_FRAC;
+// The random draws do not depend on the parameters being swept, so each
+// packet draws a single uniform number that is compared against every
+// drop fraction, and the resulting counters are classified for every
+// threshold/probability/ratio combination in the same pass. This is the
+// scalar kernel, the reference for the vectorized ones in simd.cc.
+void run_montecarlo(const sweep &sw, std::vector<results> &res, int runs) {
+    // per drop fraction counters of the flow being simulated
+    struct counters {
+        int dupcount;  // as seen at monitor
+        int origdupcount; // as sent by attacker
+        int dropcount;
+        int correctcount;
+        bool dropped;
+    };
+    std::vector<counters> cnt(sw.drop_frac.size());
+    std::vector<double> p_bidir(sw.prob_legit_src.size());
+
+    for (int run = 0; run < runs; run++) {
+        for (int dups = 2; dups < sw.max_dups; dups++) {
+            for (counters &c : cnt) {
+                c = counters();
+            }
+            for (int n = 1; n < sw.max_n; n++) {
+                double u = rnd();
                 bool duplicated = false;
                 if (n <= dups) duplicated = true;
 
-                if (dropped && duplicated) {
-                    correctcount++;
-                    dropcount++;
-                    origdupcount++;
-                } else if (dropped) {
-                    dropcount++;
-                } else if (duplicated) {
-                    dupcount++;
-                    origdupcount++;
+                for (size_t df = 0; df < sw.drop_frac.size(); df++) {
+                    counters &c = cnt[df];
+                    c.dropped = u <= sw.drop_frac[df];
+                    if (c.dropped && duplicated) {
+                        c.correctcount++;
+                        c.dropcount++;
+                        c.origdupcount++;
+                    } else if (c.dropped) {
+                        c.dropcount++;
+                    } else if (duplicated) {
+                        c.dupcount++;
+                        c.origdupcount++;
+                    }
+                    assert(c.origdupcount < sw.max_dups);
                 }
-                assert(origdupcount < MAX_DUPS);
                 if (n < dups) {
                     continue;
                 }
 
-                totalresults[n][dupcount]++;
-                if (n != dropped && (double)dupcount / (n - dropped) > MAX_DUP_THRESH) {
-                    max_dups[n][origdupcount]++;
-                } else {
-                    double h1 = pow(1 - PROB_LEGIT_SRC, (double)(dropcount - correctcount));
-                    double h2;
-                    if (dupcount == 0) {
-                        h2 = pow(1.0 / n, (double)correctcount);
-                    } else {
-                        h2 = pow((double)dupcount / n, (double)correctcount);
+                for (size_t df = 0; df < sw.drop_frac.size(); df++) {
+                    const counters &c = cnt[df];
+                    bool computed = false;
+                    for (size_t th = 0; th < sw.dup_thresh.size(); th++) {
+                        bool exceeded = n != c.dropped &&
+                            (double)c.dupcount / (n - c.dropped) > sw.dup_thresh[th];
+                        if (!exceeded && !computed) {
+                            for (size_t pl = 0; pl < sw.prob_legit_src.size(); pl++) {
+                                p_bidir[pl] = prob_bidir(sw.prob_legit_src[pl], n,
+                                    c.dupcount, c.dropcount, c.correctcount);
+                            }
+                            computed = true;
+                        }
+                        for (size_t pl = 0; pl < sw.prob_legit_src.size(); pl++) {
+                            for (size_t ra = 0; ra < sw.h1_h2_ratio.size(); ra++) {
+                                results &r = res[sw.index(df, th, pl, ra)];
+                                int idx = r.index(n, c.origdupcount);
+                                r.totalresults[r.index(n, c.dupcount)]++;
+                                if (exceeded) {
+                                    r.max_dups_exceeded[idx]++;
+                                } else {
+                                    r.add(classify(p_bidir[pl], sw.h1_h2_ratio[ra]), idx, 1);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Exact counterpart of run_montecarlo() for a single point. For D
+// duplicates and n >= D packets, the state seen by the monitor is fully
+// described by
+//   c  - dropped duplicates (correctcount), c ~ Bin(D, drop_frac)
+//   k  - dropped non-duplicates, k = k' + f with k' ~ Bin(n - D - 1, drop_frac)
+//   f  - whether the current packet was dropped
+// (for n == D the current packet is the last duplicate, so f is part
+// of c instead and k is zero). The binomial pmfs are built by dynamic
+// programming over n in the log domain, and the expected counts are
+// accumulated directly instead of being sampled.
+void run_exact(const sweep &sw, const point &pt, results &res) {
+    const int max_n = sw.max_n;
+    const double lp = log(pt.drop_frac);
+    const double lq = log(1 - pt.drop_frac);
+
+    // logpmf[m][k] = log P(Bin(m, drop_frac) = k)
+    std::vector<std::vector<double>> logpmf(max_n);
+    logpmf[0].assign(1, 0.0);
+    for (int m = 1; m < max_n; m++) {
+        logpmf[m].assign(m + 1, -INFINITY);
+        for (int k = 0; k <= m; k++) {
+            double keep = k < m ? logpmf[m - 1][k] + lq : -INFINITY;
+            double drop = k > 0 ? logpmf[m - 1][k - 1] + lp : -INFINITY;
+            double hi = fmax(keep, drop);
+            if (hi != -INFINITY) {
+                logpmf[m][k] = hi + log1p(exp(fmin(keep, drop) - hi));
+            }
+        }
+    }
+
+    // pmf[m][k] and its upper tail tail[m][k] = P(Bin(m) >= k), summed
+    // from the top so that small tail probabilities keep their precision
+    std::vector<std::vector<double>> pmf(max_n), tail(max_n);
+    for (int m = 0; m < max_n; m++) {
+        pmf[m].resize(m + 1);
+        tail[m].assign(m + 2, 0.0);
+        for (int k = m; k >= 0; k--) {
+            pmf[m][k] = exp(logpmf[m][k]);
+            tail[m][k] = tail[m][k + 1] + pmf[m][k];
+        }
+    }
+
+    for (int dups = 2; dups < sw.max_dups; dups++) {
+        for (int n = dups; n < max_n; n++) {
+            int idx = res.index(n, dups);
+            for (int f = 0; f <= 1; f++) {
+                double pf = f ? pt.drop_frac : 1 - pt.drop_frac;
+                // the current packet is a duplicate when n == dups, and
+                // then its drop is one of the dups trials
+                int dup_trials = n == dups ? dups - 1 : dups;
+                int m = n == dups ? 0 : n - dups - 1;
+                for (int c0 = 0; c0 <= dup_trials; c0++) {
+                    int c = n == dups ? c0 + f : c0;
+                    int dupcount = dups - c;
+                    double pc = sw.runs * pf * pmf[dup_trials][c0];
+
+                    res.totalresults[res.index(n, dupcount)] += pc;
+                    if ((double)dupcount / (n - f) > pt.dup_thresh) {
+                        res.max_dups_exceeded[idx] += pc;
+                        continue;
+                    }
+                    if (n == dups) {
+                        double p = prob_bidir(pt.prob_legit_src, n, dupcount, c, c);
+                        res.add(classify(p, pt.h1_h2_ratio), idx, pc);
+                        continue;
                     }
-                    double p_bidir = h1 / (h1 + h2);
-                    if (p_bidir > (1 - H1_H2_RATIO)) {
-                        bidir[n][origdupcount]++;
-                    } else if (p_bidir < H1_H2_RATIO) {
-                        non_bidir[n][origdupcount]++;
-                    } else {
-                        undecided[n][origdupcount]++;
+                    // p_bidir decreases with the number of dropped
+                    // non-duplicates, so walk k' up until the verdict
+                    // becomes NON_BIDIR and take the rest from the tail
+                    int k = 0;
+                    for (; k <= m; k++) {
+                        double p = prob_bidir(pt.prob_legit_src, n, dupcount, c + k + f, c);
+                        verdict v = classify(p, pt.h1_h2_ratio);
+                        if (v == NON_BIDIR) {
+                            break;
+                        }
+                        res.add(v, idx, pc * pmf[m][k]);
                     }
+                    res.non_bidir[idx] += pc * tail[m][k];
                 }
             }
         }
     }
+}
+
+// Formats row (n, d) of one point into line, returning false if the
+// row is empty. The plain format is the one plot.gp reads from the per-d
+// files; the structured format prefixes every row with the parameters of
+// its point so that a whole sweep fits in one file.
+bool format_row(char *line, size_t len, const point &pt, const results &res,
+    int n, int d, bool structured) {
+    int idx = res.index(n, d);
+    long long tot = llround(res.totalresults[idx]);
+    if (tot <= 0) {
+        return false;
+    }
+    double total = res.totalresults[idx];
+    double dups = res.max_dups_exceeded[idx] / total;
+    double bid = res.bidir[idx] / total;
+    double nobid = res.non_bidir[idx] / total;
+    double undec = res.undecided[idx] / total;
+    if (structured) {
+        snprintf(line, len, "%g %g %g %g %d %d %lld %f %f %f %f %f\n",
+            pt.drop_frac, pt.dup_thresh, pt.prob_legit_src, pt.h1_h2_ratio,
+            n, d, tot, dups, bid, nobid, undec, dups + bid + nobid + undec);
+    } else {
+        snprintf(line, len, "n %d d %d tot %lld dups %f bid %f nobid %f undec %f sum %f\n",
+            n, d, tot, dups, bid, nobid, undec, dups + bid + nobid + undec);
+    }
+    return true;
+}
+
+// Writes finished points from a background thread, so that formatting
+// and writing one point overlaps with the computation of the next. Each
+// point goes to the main output (stdout or --output) and, with --split,
+// to one file per d in the plain format, ready for plot.gp.
+struct writer {
+    FILE *out;
+    bool structured;
+    std::string split_dir;  // empty if not splitting
+    bool per_point_dirs;    // one split subdirectory per point of a sweep
+
+    std::deque<std::pair<point, const results *>> queue;
+    std::mutex lock;
+    std::condition_variable ready;
+    bool done = false;
+    bool failed = false;
+    std::thread thread;
+
+    writer(FILE *out, bool structured, const char *split_dir, bool per_point_dirs)
+        : out(out),
+          structured(structured),
+          split_dir(split_dir ? split_dir : ""),
+          per_point_dirs(per_point_dirs),
+          thread(&writer::loop, this) {}
+
+    // the results must stay alive until finish() returns
+    void push(const point &pt, const results &res) {
+        std::lock_guard<std::mutex> guard(lock);
+        queue.emplace_back(pt, &res);
+        ready.notify_one();
+    }
+
+    // waits for all the pushed points to be written
+    bool finish() {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            done = true;
+            ready.notify_one();
+        }
+        thread.join();
+        return !failed;
+    }
 
-    for (int n = 1; n < MAX_N; n++) {
-        for (int d = 0; d < MAX_DUPS; d++) {
-            if (totalresults[n][d] > 0) {
-                printf("n %d d %d tot %d dups %f bid %f nobid %f undec %f sum %f\n",
-                    n, d, totalresults[n][d],
-                    (double)max_dups[n][d] / totalresults[n][d],
-                    (double)bidir[n][d] / totalresults[n][d],
-                    (double)non_bidir[n][d] / totalresults[n][d],
-                    (double)undecided[n][d] / totalresults[n][d],
-                    (double)max_dups[n][d] / totalresults[n][d] +
-                    (double)bidir[n][d] / totalresults[n][d] +
-                    (double)non_bidir[n][d] / totalresults[n][d] +
-                    (double)undecided[n][d] / totalresults[n][d]);
+    void loop() {
+        for (;;) {
+            std::unique_lock<std::mutex> guard(lock);
+            ready.wait(guard, [this] { return done || !queue.empty(); });
+            if (queue.empty()) {
+                return;
             }
+            std::pair<point, const results *> job = queue.front();
+            queue.pop_front();
+            guard.unlock();
+
+            write(job.first, *job.second);
+        }
+    }
+
+    void write(const point &pt, const results &res) {
+        char line[256];
+        std::string table;
+        std::vector<std::string> by_d(split_dir.empty() ? 0 : res.max_dups);
+        for (int n = 1; n < res.max_n; n++) {
+            for (int d = 0; d < res.max_dups; d++) {
+                if (format_row(line, sizeof(line), pt, res, n, d, structured)) {
+                    table += line;
+                }
+                if (!by_d.empty() && format_row(line, sizeof(line), pt, res, n, d, false)) {
+                    by_d[d] += line;
+                }
+            }
+        }
+        if (fwrite(table.data(), 1, table.size(), out) != table.size()) {
+            failed = true;
+        }
+        if (by_d.empty()) {
+            return;
         }
+
+        std::string dir = split_dir;
+        if (per_point_dirs) {
+            snprintf(line, sizeof(line), "/df%g_th%g_pl%g_r%g",
+                pt.drop_frac, pt.dup_thresh, pt.prob_legit_src, pt.h1_h2_ratio);
+            dir += line;
+            if (mkdir(dir.c_str(), 0755) != 0 && errno != EEXIST) {
+                perror(dir.c_str());
+                failed = true;
+                return;
+            }
+        }
+        for (int d = 0; d < res.max_dups; d++) {
+            if (by_d[d].empty()) {
+                continue;
+            }
+            std::string path = dir + "/d" + std::to_string(d);
+            FILE *f = fopen(path.c_str(), "w");
+            if (!f || fwrite(by_d[d].data(), 1, by_d[d].size(), f) != by_d[d].size()) {
+                perror(path.c_str());
+                failed = true;
+            }
+            if (f) {
+                fclose(f);
+            }
+        }
+    }
+};
+
+// Parses either a comma separated list of values ("0.05,0.1") or an
+// inclusive range ("0.01:0.1:0.01").
+bool parse_grid(const char *arg, std::vector<double> &grid) {
+    grid.clear();
+    double start, stop, step;
+    char tail;
+    if (sscanf(arg, "%lf:%lf:%lf%c", &start, &stop, &step, &tail) == 3) {
+        if (step <= 0 || stop < start) {
+            return false;
+        }
+        long steps = lround(floor((stop - start) / step + 1e-9));
+        for (long i = 0; i <= steps; i++) {
+            grid.push_back(start + i * step);
+        }
+        return true;
+    }
+    std::string list(arg);
+    size_t pos = 0;
+    while (pos <= list.size()) {
+        size_t end = list.find(',', pos);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        std::string item = list.substr(pos, end - pos);
+        char *endp;
+        double v = strtod(item.c_str(), &endp);
+        if (item.empty() || *endp != '\0') {
+            return false;
+        }
+        grid.push_back(v);
+        pos = end + 1;
+    }
+    return !grid.empty();
+}
+
+bool valid_probabilities(const std::vector<double> &grid, bool open_interval) {
+    for (double v : grid) {
+        if (v < 0 || v > 1 || (open_interval && (v == 0 || v == 1))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [options]\n", prog);
+    fprintf(stderr, "  --exact                 compute the expected results exactly instead of by Monte Carlo\n");
+    fprintf(stderr, "  --runs R                number of Monte Carlo runs (default %d)\n", NUM_RUNS);
+    fprintf(stderr, "  --max-n N               number of packets per flow (default %d)\n", MAX_N);
+    fprintf(stderr, "  --max-dups D            bound on the duplicates sent by the attacker (default %d)\n", MAX_DUPS);
+    fprintf(stderr, "  --dup-thresh GRID       duplicate threshold (default %g)\n", MAX_DUP_THRESH);
+    fprintf(stderr, "  --drop-frac GRID        fraction of packets dropped (default %g)\n", DROP_FRAC);
+    fprintf(stderr, "  --prob-legit-src GRID   probability of a legitimate source (default %g)\n", PROB_LEGIT_SRC);
+    fprintf(stderr, "  --h1-h2-ratio GRID      decision ratio (default %g)\n", H1_H2_RATIO);
+    fprintf(stderr, "  --kernel K              Monte Carlo kernel: auto (default), scalar, avx2 or avx512\n");
+    fprintf(stderr, "  --output FILE           write the whole sweep to FILE in the structured format\n");
+    fprintf(stderr, "  --split DIR             also write the rows of each d to DIR/d<d> (one subdirectory\n");
+    fprintf(stderr, "                          per point for sweeps), in the format read by plot.gp\n");
+    fprintf(stderr, "A GRID is a comma separated list (0.05,0.1) or an inclusive range (0.01:0.1:0.01).\n");
+    fprintf(stderr, "Sweeps with more than one point are always written in the structured format,\n");
+    fprintf(stderr, "one row per (point, n, d):\n");
+    fprintf(stderr, "  drop_frac dup_thresh prob_legit_src h1_h2_ratio n d tot dups bid nobid undec sum\n");
+}
+
+int main(int argc, char **argv) {
+    bool exact = false;
+    kernel k = KERNEL_AUTO;
+    const char *output = NULL;
+    const char *split_dir = NULL;
+    sweep sw;
+    sw.drop_frac = {DROP_FRAC};
+    sw.dup_thresh = {MAX_DUP_THRESH};
+    sw.prob_legit_src = {PROB_LEGIT_SRC};
+    sw.h1_h2_ratio = {H1_H2_RATIO};
+
+    enum {
+        OPT_RUNS = 256,
+        OPT_MAX_N,
+        OPT_MAX_DUPS,
+        OPT_DUP_THRESH,
+        OPT_DROP_FRAC,
+        OPT_PROB_LEGIT_SRC,
+        OPT_H1_H2_RATIO,
+        OPT_KERNEL,
+    };
+    static struct option long_options[] = {
+        {"exact", no_argument, 0, 'e'},
+        {"output", required_argument, 0, 'o'},
+        {"split", required_argument, 0, 's'},
+        {"runs", required_argument, 0, OPT_RUNS},
+        {"max-n", required_argument, 0, OPT_MAX_N},
+        {"max-dups", required_argument, 0, OPT_MAX_DUPS},
+        {"dup-thresh", required_argument, 0, OPT_DUP_THRESH},
+        {"drop-frac", required_argument, 0, OPT_DROP_FRAC},
+        {"prob-legit-src", required_argument, 0, OPT_PROB_LEGIT_SRC},
+        {"h1-h2-ratio", required_argument, 0, OPT_H1_H2_RATIO},
+        {"kernel", required_argument, 0, OPT_KERNEL},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+    int opt;
+    bool ok = true;
+    while ((opt = getopt_long(argc, argv, "eo:s:h", long_options, NULL)) != -1) {
+        switch (opt) {
+        case 'e':
+            exact = true;
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        case 's':
+            split_dir = optarg;
+            break;
+        case OPT_RUNS:
+            sw.runs = atoi(optarg);
+            ok = sw.runs > 0;
+            break;
+        case OPT_MAX_N:
+            sw.max_n = atoi(optarg);
+            ok = sw.max_n > 2;
+            break;
+        case OPT_MAX_DUPS:
+            sw.max_dups = atoi(optarg);
+            ok = sw.max_dups > 2;
+            break;
+        case OPT_DUP_THRESH:
+            ok = parse_grid(optarg, sw.dup_thresh);
+            break;
+        case OPT_DROP_FRAC:
+            ok = parse_grid(optarg, sw.drop_frac) && valid_probabilities(sw.drop_frac, true);
+            break;
+        case OPT_PROB_LEGIT_SRC:
+            ok = parse_grid(optarg, sw.prob_legit_src) && valid_probabilities(sw.prob_legit_src, false);
+            break;
+        case OPT_H1_H2_RATIO:
+            ok = parse_grid(optarg, sw.h1_h2_ratio) && valid_probabilities(sw.h1_h2_ratio, false);
+            break;
+        case OPT_KERNEL:
+            if (!strcmp(optarg, "auto")) {
+                k = KERNEL_AUTO;
+            } else if (!strcmp(optarg, "scalar")) {
+                k = KERNEL_SCALAR;
+            } else if (!strcmp(optarg, "avx2")) {
+                k = KERNEL_AVX2;
+            } else if (!strcmp(optarg, "avx512")) {
+                k = KERNEL_AVX512;
+            } else {
+                ok = false;
+            }
+            break;
+        case 'h':
+            usage(argv[0]);
+            return 0;
+        default:
+            ok = false;
+            break;
+        }
+        if (!ok) {
+            if (opt != '?') {
+                fprintf(stderr, "%s: invalid argument '%s'\n", argv[0], optarg);
+            }
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (k == KERNEL_AUTO) {
+        k = kernel_detect();
+    } else if (!kernel_supported(k)) {
+        fprintf(stderr, "%s: the CPU does not support the requested kernel\n", argv[0]);
+        return 1;
+    }
+
+    FILE *out = stdout;
+    if (output) {
+        out = fopen(output, "w");
+        if (!out) {
+            perror(output);
+            return 1;
+        }
+    }
+    setvbuf(out, NULL, _IOFBF, 1 << 20);
+    bool structured = output || sw.num_points() > 1;
+    if (split_dir && mkdir(split_dir, 0755) != 0 && errno != EEXIST) {
+        perror(split_dir);
+        return 1;
+    }
+
+    if (structured) {
+        fprintf(out, "# mode %s runs %d max_n %d max_dups %d\n",
+            exact ? "exact" : "montecarlo", sw.runs, sw.max_n, sw.max_dups);
+        fprintf(out, "# drop_frac dup_thresh prob_legit_src h1_h2_ratio n d tot dups bid nobid undec sum\n");
+    }
+
+    std::vector<results> res(sw.num_points(), results(sw.max_n, sw.max_dups));
+    writer w(out, structured, split_dir, sw.num_points() > 1);
+    if (exact) {
+        // the points are independent, so each one is written while the
+        // next one is computed
+        for (size_t i = 0; i < res.size(); i++) {
+            run_exact(sw, sw.at(i), res[i]);
+            w.push(sw.at(i), res[i]);
+        }
+    } else {
+        // the Monte Carlo shares its draws across the whole sweep, so the
+        // points are all complete at the same time
+        int done = run_montecarlo_simd(sw, res, k);
+        run_montecarlo(sw, res, sw.runs - done);
+        for (size_t i = 0; i < res.size(); i++) {
+            w.push(sw.at(i), res[i]);
+        }
+    }
+    bool ok_written = w.finish();
+
+    if (fflush(out) != 0) {
+        ok_written = false;
+    }
+    if (out != stdout) {
+        fclose(out);
     }
+    return ok_written ? 0 : 1;
 }
@@ -0,0 +1,146 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <math.h>
+#include <vector>
+
+// default parameters, each of them can be overridden (or swept over a
+// grid of values) from the command line - see usage()
+#define MAX_N 400
+
+// beware - there's a truncation effect that happens just before
+// MAX_DUPS, so set MAX_DUPS to be greater than the maximum duplicates
+// that you care about evaluating.
+#define MAX_DUPS 50
+
+#define MAX_DUP_THRESH 0.15
+#define DROP_FRAC 0.05
+#define PROB_LEGIT_SRC 0.95
+#define H1_H2_RATIO 0.01
+
+// number of Monte Carlo runs; the exact mode scales its expected
+// counts by the same number so that the "tot" column is comparable.
+#define NUM_RUNS 1000000
+
+enum verdict { BIDIR, NON_BIDIR, UNDECIDED };
+
+// one point of the parameter space
+struct point {
+    double drop_frac;
+    double dup_thresh;
+    double prob_legit_src;
+    double h1_h2_ratio;
+};
+
+// the grids to sweep over; a plain run is a sweep with a single point
+struct sweep {
+    int max_n = MAX_N;
+    int max_dups = MAX_DUPS;
+    int runs = NUM_RUNS;
+    std::vector<double> drop_frac;
+    std::vector<double> dup_thresh;
+    std::vector<double> prob_legit_src;
+    std::vector<double> h1_h2_ratio;
+
+    size_t num_points() const {
+        return drop_frac.size() * dup_thresh.size() * prob_legit_src.size() * h1_h2_ratio.size();
+    }
+
+    // points are ordered with drop_frac varying slowest and h1_h2_ratio fastest
+    size_t index(size_t df, size_t th, size_t pl, size_t ra) const {
+        return ((df * dup_thresh.size() + th) * prob_legit_src.size() + pl) * h1_h2_ratio.size() + ra;
+    }
+
+    point at(size_t idx) const {
+        point p;
+        p.h1_h2_ratio = h1_h2_ratio[idx % h1_h2_ratio.size()];
+        idx /= h1_h2_ratio.size();
+        p.prob_legit_src = prob_legit_src[idx % prob_legit_src.size()];
+        idx /= prob_legit_src.size();
+        p.dup_thresh = dup_thresh[idx % dup_thresh.size()];
+        idx /= dup_thresh.size();
+        p.drop_frac = drop_frac[idx];
+        return p;
+    }
+};
+
+// (expected) counts for different combinations of N and D (where D is
+// number of dups sent by the malicious user), sized at runtime
+struct results {
+    int max_n;
+    int max_dups;
+    std::vector<double> undecided;
+    std::vector<double> bidir;
+    std::vector<double> non_bidir;
+    std::vector<double> max_dups_exceeded;
+    std::vector<double> totalresults;
+
+    results(int max_n, int max_dups)
+        : max_n(max_n),
+          max_dups(max_dups),
+          undecided(max_n * max_dups, 0.0),
+          bidir(max_n * max_dups, 0.0),
+          non_bidir(max_n * max_dups, 0.0),
+          max_dups_exceeded(max_n * max_dups, 0.0),
+          totalresults(max_n * max_dups, 0.0) {}
+
+    int index(int n, int d) const {
+        return n * max_dups + d;
+    }
+
+    void add(verdict v, int idx, double weight) {
+        switch (v) {
+        case BIDIR:
+            bidir[idx] += weight;
+            break;
+        case NON_BIDIR:
+            non_bidir[idx] += weight;
+            break;
+        case UNDECIDED:
+            undecided[idx] += weight;
+            break;
+        }
+    }
+};
+
+double rnd();
+
+// probability that a flow that did not exceed the duplicate threshold
+// is bidirectional, shared by the Monte Carlo and the exact mode.
+inline double prob_bidir(double prob_legit_src, int n, int dupcount, int dropcount, int correctcount) {
+    double h1 = pow(1 - prob_legit_src, (double)(dropcount - correctcount));
+    double h2;
+    if (dupcount == 0) {
+        h2 = pow(1.0 / n, (double)correctcount);
+    } else {
+        h2 = pow((double)dupcount / n, (double)correctcount);
+    }
+    return h1 / (h1 + h2);
+}
+
+inline verdict classify(double p_bidir, double h1_h2_ratio) {
+    if (p_bidir > (1 - h1_h2_ratio)) {
+        return BIDIR;
+    } else if (p_bidir < h1_h2_ratio) {
+        return NON_BIDIR;
+    }
+    return UNDECIDED;
+}
+
+// Monte Carlo kernels. SCALAR is the reference implementation in sim.cc,
+// the others are the vectorized kernels in simd.cc.
+enum kernel { KERNEL_AUTO, KERNEL_SCALAR, KERNEL_AVX2, KERNEL_AVX512 };
+
+// whether the CPU can run the given kernel
+bool kernel_supported(kernel k);
+
+// the best kernel the CPU supports
+kernel kernel_detect();
+
+// Runs the Monte Carlo for as many whole groups of runs as fit in
+// sw.runs with the given vectorized kernel, consuming the random draws
+// in the same order as the scalar kernel would. Returns the number of
+// runs done; the caller does the remaining ones with the scalar kernel.
+int run_montecarlo_simd(const sweep &sw, std::vector<results> &res, kernel k);
+
+#endif // SIM_H
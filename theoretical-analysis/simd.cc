@@ -0,0 +1,248 @@
+#include <stdio.h>
+#include <math.h>
+#include <vector>
+
+#include "sim.h"
+
+// Vectorized Monte Carlo kernel. A group of LANES independent runs is
+// simulated side by side, one run per vector lane: the counters are
+// updated branchlessly from the drop masks, and the classification is
+// done in the log domain, where
+//   s = log(h2 / h1) = correctcount * log(dupcount / n)
+//                      - (dropcount - correctcount) * log(1 - prob_legit_src)
+// so that p_bidir > 1 - r  <=>  s < log(r / (1 - r)) and
+//         p_bidir < r      <=>  s > log((1 - r) / r).
+// Lanes whose score is within LOG_EPS of a decision boundary, or for
+// which pow() could underflow in the scalar kernel, are classified with
+// the scalar code instead, so the verdicts are bit-for-bit those of the
+// scalar kernel. The kernel body is compiled once per instruction set
+// and selected at runtime.
+
+#define LANES 16
+
+// margin around the decision boundaries, far larger than the rounding
+// error of either the log-domain score or the pow-based probability
+#define LOG_EPS 1e-6
+
+// below this, pow() in the scalar kernel gets close to the denormals
+#define LOG_UNDERFLOW -700.0
+
+// the alignment is spelled out because the default one depends on the
+// instruction set each function is compiled for
+typedef double vdouble __attribute__((vector_size(LANES * sizeof(double)), aligned(64)));
+typedef long long vmask __attribute__((vector_size(LANES * sizeof(long long)), aligned(64)));
+
+namespace {
+
+// per sweep values of the log-domain classification
+struct tables {
+    // log(max(x, 1) / n), indexed by n * max_dups + x
+    std::vector<double> log_ratio;
+    // log(1 - prob_legit_src), per prob_legit_src
+    std::vector<double> log_h1;
+    // decision boundaries of s, per h1_h2_ratio
+    std::vector<double> lo;
+    std::vector<double> hi;
+
+    explicit tables(const sweep &sw)
+        : log_ratio(sw.max_n * sw.max_dups, 0.0) {
+        for (int n = 1; n < sw.max_n; n++) {
+            for (int x = 0; x < sw.max_dups; x++) {
+                log_ratio[n * sw.max_dups + x] = log((double)(x == 0 ? 1 : x) / n);
+            }
+        }
+        for (double pl : sw.prob_legit_src) {
+            log_h1.push_back(log(1 - pl));
+        }
+        for (double r : sw.h1_h2_ratio) {
+            lo.push_back(log(r / (1 - r)));
+            hi.push_back(log((1 - r) / r));
+        }
+    }
+};
+
+// counters of LANES flows, held as doubles (exact for these values)
+struct lane_counters {
+    vdouble dupcount;
+    vdouble dropcount;
+    vdouble correctcount;
+    vdouble dropped;
+};
+
+inline __attribute__((always_inline)) vdouble splat(double v) {
+    return vdouble{} + v;
+}
+
+inline __attribute__((always_inline)) int count(const vmask &m) {
+    int c = 0;
+    for (int l = 0; l < LANES; l++) {
+        c -= (int)m[l];
+    }
+    return c;
+}
+
+// Classifies the LANES flows of one drop fraction at packet n for every
+// threshold/probability/ratio combination of the sweep.
+inline __attribute__((always_inline)) void classify_group(const sweep &sw, const tables &tb,
+    size_t df, int n, int dups, const lane_counters &c, std::vector<results> &res) {
+    int idx = n * sw.max_dups + dups;  // origdupcount == dups for n >= dups
+
+    // per-lane histogram of the duplicates seen at the monitor
+    int dupcount[LANES];
+    vdouble log_ratio;
+    for (int l = 0; l < LANES; l++) {
+        dupcount[l] = (int)c.dupcount[l];
+        log_ratio[l] = tb.log_ratio[n * sw.max_dups + dupcount[l]];
+    }
+    vdouble ratio = c.dupcount / (splat(n) - c.dropped);
+    vdouble k = c.dropcount - c.correctcount;
+    vdouble log_h2 = c.correctcount * log_ratio;
+
+    for (size_t th = 0; th < sw.dup_thresh.size(); th++) {
+        vmask exceeded = ratio > sw.dup_thresh[th];
+        int n_exceeded = count(exceeded);
+
+        for (size_t pl = 0; pl < sw.prob_legit_src.size(); pl++) {
+            bool scalar_only = !isfinite(tb.log_h1[pl]);
+            vdouble log_h1 = k * tb.log_h1[pl];
+            vdouble s = log_h2 - log_h1;
+            vmask risky = (log_h1 < LOG_UNDERFLOW) | (log_h2 < LOG_UNDERFLOW);
+
+            for (size_t ra = 0; ra < sw.h1_h2_ratio.size(); ra++) {
+                results &r = res[sw.index(df, th, pl, ra)];
+                for (int l = 0; l < LANES; l++) {
+                    r.totalresults[n * sw.max_dups + dupcount[l]]++;
+                }
+                r.max_dups_exceeded[idx] += n_exceeded;
+                if (n_exceeded == LANES) {
+                    continue;
+                }
+
+                double lo = tb.lo[ra];
+                double hi = tb.hi[ra];
+                vdouble dlo = s - lo;
+                vdouble dhi = s - hi;
+                vmask near = risky | ((dlo < 0 ? -dlo : dlo) < LOG_EPS) |
+                    ((dhi < 0 ? -dhi : dhi) < LOG_EPS);
+                if (scalar_only) {
+                    near = ~vmask{};
+                }
+                vmask fast = ~exceeded & ~near;
+                vmask bidir = fast & (s < lo);
+                vmask non_bidir = fast & ~(s < lo) & (s > hi);
+                vmask undecided = fast & ~(s < lo) & ~(s > hi);
+                r.bidir[idx] += count(bidir);
+                r.non_bidir[idx] += count(non_bidir);
+                r.undecided[idx] += count(undecided);
+
+                vmask slow = ~exceeded & near;
+                for (int l = 0; l < LANES; l++) {
+                    if (slow[l]) {
+                        double p = prob_bidir(sw.prob_legit_src[pl], n, dupcount[l],
+                            (int)c.dropcount[l], (int)c.correctcount[l]);
+                        r.add(classify(p, sw.h1_h2_ratio[ra]), idx, 1);
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Simulates one group of LANES runs; u holds their random draws,
+// indexed by (dups * max_n + n) * LANES + lane.
+inline __attribute__((always_inline)) void run_group(const sweep &sw, const tables &tb,
+    const double *u, std::vector<lane_counters> &cnt, std::vector<results> &res) {
+    const vdouble one = splat(1);
+    const vdouble zero = splat(0);
+    for (int dups = 2; dups < sw.max_dups; dups++) {
+        for (lane_counters &c : cnt) {
+            c = lane_counters{};
+        }
+        for (int n = 1; n < sw.max_n; n++) {
+            vdouble draw;
+            __builtin_memcpy(&draw, u + ((size_t)dups * sw.max_n + n) * LANES, sizeof(draw));
+            // origdupcount is n while duplicating and dups afterwards,
+            // so it need not be tracked per lane
+            bool duplicated = n <= dups;
+
+            for (size_t df = 0; df < sw.drop_frac.size(); df++) {
+                lane_counters &c = cnt[df];
+                c.dropped = draw <= sw.drop_frac[df] ? one : zero;
+                c.dropcount += c.dropped;
+                if (duplicated) {
+                    c.correctcount += c.dropped;
+                    c.dupcount += 1 - c.dropped;
+                }
+            }
+            if (n < dups) {
+                continue;
+            }
+
+            for (size_t df = 0; df < sw.drop_frac.size(); df++) {
+                classify_group(sw, tb, df, n, dups, cnt[df], res);
+            }
+        }
+    }
+}
+
+__attribute__((target("avx512f,avx512dq"))) void run_group_avx512(const sweep &sw,
+    const tables &tb, const double *u, std::vector<lane_counters> &cnt, std::vector<results> &res) {
+    run_group(sw, tb, u, cnt, res);
+}
+
+__attribute__((target("avx2,fma"))) void run_group_avx2(const sweep &sw,
+    const tables &tb, const double *u, std::vector<lane_counters> &cnt, std::vector<results> &res) {
+    run_group(sw, tb, u, cnt, res);
+}
+
+} // namespace
+
+bool kernel_supported(kernel k) {
+    __builtin_cpu_init();
+    switch (k) {
+    case KERNEL_AUTO:
+    case KERNEL_SCALAR:
+        return true;
+    case KERNEL_AVX2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    case KERNEL_AVX512:
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq");
+    }
+    return false;
+}
+
+kernel kernel_detect() {
+    if (kernel_supported(KERNEL_AVX512)) {
+        return KERNEL_AVX512;
+    } else if (kernel_supported(KERNEL_AVX2)) {
+        return KERNEL_AVX2;
+    }
+    return KERNEL_SCALAR;
+}
+
+int run_montecarlo_simd(const sweep &sw, std::vector<results> &res, kernel k) {
+    if (k != KERNEL_AVX2 && k != KERNEL_AVX512) {
+        return 0;
+    }
+    tables tb(sw);
+    std::vector<lane_counters> cnt(sw.drop_frac.size());
+    std::vector<double> u((size_t)sw.max_dups * sw.max_n * LANES);
+
+    int run = 0;
+    for (; run + LANES <= sw.runs; run += LANES) {
+        // draw in the order of the scalar kernel: run, then dups, then n
+        for (int l = 0; l < LANES; l++) {
+            for (int dups = 2; dups < sw.max_dups; dups++) {
+                for (int n = 1; n < sw.max_n; n++) {
+                    u[((size_t)dups * sw.max_n + n) * LANES + l] = rnd();
+                }
+            }
+        }
+        if (k == KERNEL_AVX512) {
+            run_group_avx512(sw, tb, u.data(), cnt, res);
+        } else {
+            run_group_avx2(sw, tb, u.data(), cnt, res);
+        }
+    }
+    return run;
+}